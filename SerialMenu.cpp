@@ -8,6 +8,8 @@
  #include "sd_card_manager.h" // To call SD card functions [cite: uploaded:my_projects/SerialMenu.cpp]
  #include "openrocket_parser.h" // To call parsing/calculation functions [cite: uploaded:my_projects/SerialMenu.cpp]
  #include "servo_controller.h" // << ADDED: To call servo functions
+ #include "flip_schedule.h"    // Servo flips found at load time
+ #include "config_store.h"     // Saved radius and servo travel time
 
  #include <iostream>          // For cout [cite: uploaded:my_projects/SerialMenu.cpp]
  #include <cstdio>            // For printf, getchar [cite: uploaded:my_projects/SerialMenu.cpp]
@@ -16,6 +18,7 @@
  #include <cstring>           // For memset, strchr [cite: uploaded:my_projects/SerialMenu.cpp]
  #include <cstdlib>           // For atof, atoi [cite: uploaded:my_projects/SerialMenu.cpp]
  #include <cctype>            // For isdigit, isprint [cite: uploaded:my_projects/SerialMenu.cpp]
+ #include <cmath>             // For M_PI
  #include "pico/time.h"       // For simulation timing [cite: uploaded:my_projects/SerialMenu.cpp]
 
 
@@ -27,6 +30,9 @@
  // Configuration Variables (with defaults)
  static float s_configured_radius_cm = 15.0f; // Default radius [cite: uploaded:my_projects/SerialMenu.cpp]
 
+ // Standard gravity, for converting achieved centripetal acceleration to G
+ static const float STANDARD_GRAVITY = 9.80665f; // m/s^2
+
 
  // --- Helper Functions for Input Reading ---
 
@@ -116,6 +122,61 @@
      return value;
  }
 
+ /**
+  * @brief Reads a line of text (printable characters) from the serial input. (BLOCKING)
+  * @return The text; empty if Enter was pressed straight away.
+  */
+ static std::string menu_read_text(const char* prompt) {
+     char buffer[CSV_COLUMN_NAME_MAX];
+     size_t index = 0;
+     buffer[0] = '\0';
+
+     std::cout << std::endl << prompt;
+     std::cout.flush();
+
+     while (index < sizeof(buffer) - 1) {
+         int c = getchar(); // Blocking read
+
+         if (c == PICO_ERROR_TIMEOUT || c == PICO_ERROR_NONE) continue;
+
+         char ch = (char)c;
+
+         if (ch == '\r' || ch == '\n') {
+             std::cout << std::endl;
+             break;
+         }
+         else if ((ch == '\b' || ch == 127) && index > 0) {
+             index--;
+             buffer[index] = '\0';
+             std::cout << "\b \b";
+             std::cout.flush();
+         }
+         else if (isprint((unsigned char)ch)) {
+             buffer[index++] = ch;
+             buffer[index] = '\0';
+             std::cout << ch;
+             std::cout.flush();
+         }
+     }
+     return std::string(buffer);
+ }
+
+
+ void menu_init() {
+     float stored;
+     if (config_store_get_float(CONFIG_KEY_RADIUS_CM, &stored) && stored > 0.0f) {
+         s_configured_radius_cm = stored;
+     }
+     // The last profile is ready to run straight from flash
+     const ProfileHeader* profile = get_profile_header();
+     if (profile) {
+         printf("Profile in flash: '%s', %u points, %u flips, %.1f s, radius %.2f cm\n",
+                profile->source_name, (unsigned int)profile->point_count, (unsigned int)profile->flip_count,
+                profile->duration_us * 1e-6f, profile->radius_cm);
+     } else {
+         printf("No profile in flash. Load one with 'l'.\n");
+     }
+ }
 
  // --- Configuration Accessor ---
  float get_configured_radius_cm() { // [cite: uploaded:my_projects/SerialMenu.cpp]
@@ -131,12 +192,15 @@
      std::cout << "\n--- Serial Control Menu ---" << std::endl;
      std::cout << "t: Run Motor Test" << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
      std::cout << "v: Calibrate Servo" << std::endl; // <<< UPDATED
+     std::cout << "a: Measure Servo Latency (needs feedback)" << std::endl;
      std::cout << "s: Stop Motor Test/Simulation" << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
      std::cout << "l: Load Simulation File" << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
      std::cout << "r: Run Loaded Simulation" << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
      std::cout << "i: Initialize SD Card" << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
      std::cout << "k: Check SD Card Status" << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
      std::cout << "c: Configure Apparatus" << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
+     std::cout << "j: Toggle Step Jitter Capture (" << (motor_is_edge_capture_enabled() ? "on" : "off") << ")" << std::endl;
+     std::cout << "h: Show Step Jitter Histogram" << std::endl;
      std::cout << "m: Show this Menu" << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
      std::cout << "Enter command: ";
      std::cout.flush();
@@ -148,6 +212,25 @@
  void menu_display_config() { // [cite: uploaded:my_projects/SerialMenu.cpp]
       std::cout << "\n--- Apparatus Configuration ---" << std::endl;
       printf("  1: Radius: %.2f cm\n", s_configured_radius_cm); // [cite: uploaded:my_projects/SerialMenu.cpp]
+      MotionLimits limits = motor_get_motion_limits();
+      printf("  2: Max Accel: %.0f PPS/s\n", limits.max_accel);
+      printf("  3: Max Decel: %.0f PPS/s\n", limits.max_decel);
+      printf("  4: Max Jerk: %.0f PPS/s^2\n", limits.max_jerk);
+      printf("  5: Steps/Rev: %lu\n", (unsigned long)motor_get_steps_per_rev());
+      printf("  6: Resonance Bands:");
+      bool any_band = false;
+      for (int i = 0; i < PLANNER_MAX_BANDS; ++i) {
+          if (limits.bands[i].high_pps > limits.bands[i].low_pps) {
+              printf(" [%d] %.0f-%.0f PPS", i + 1, limits.bands[i].low_pps, limits.bands[i].high_pps);
+              any_band = true;
+          }
+      }
+      printf(any_band ? "\n" : " none\n");
+      printf("  7: Servo Slew: %.2f travel/s, %.2f travel/s^2 (0 = unlimited)\n", servo_get_max_speed(), servo_get_max_accel());
+      printf("  8: Servo Travel Time: %.0f ms (flip lead)\n", servo_get_travel_time_s() * 1000.0f);
+      printf("  9: Servo Frame Rate: %.1f Hz\n", servo_get_frame_rate_hz());
+      printf("  c: CSV Columns: time '%s', acceleration '%s'\n",
+             get_openrocket_time_column(), get_openrocket_acceleration_column());
       // Add other settings display here...
       std::cout << "\nEnter number to change, or B to go back: "; // [cite: uploaded:my_projects/SerialMenu.cpp]
       std::cout.flush();
@@ -198,6 +281,41 @@
      menu_display_main();
  }
 
+ void menu_servo_latency() {
+     if (!servo_has_feedback()) {
+         std::cout << "\nNo servo feedback (set SERVO_FEEDBACK_ENABLED in servo_controller.h)." << std::endl;
+         menu_display_main();
+         return;
+     }
+     std::cout << "\nCalibrating servo feedback..." << std::endl;
+     if (!servo_calibrate_feedback()) {
+         std::cout << "Feedback readings too close together; check the wiring." << std::endl;
+         menu_display_main();
+         return;
+     }
+     float start_s, settle_s;
+     float slowest_settle_s = 0.0f;
+     bool all_settled = true;
+     for (int direction = 0; direction < 2; ++direction) {
+         float from = (direction == 0) ? 0.0f : 1.0f;
+         bool settled = servo_measure_latency(from, 1.0f - from, &start_s, &settle_s);
+         printf("  %.0f -> %.0f: motion start %.1f ms, settled %s",
+                from, 1.0f - from, start_s * 1000.0f, settled ? "" : "never\n");
+         if (settled) {
+             printf("%.1f ms\n", settle_s * 1000.0f);
+             if (settle_s > slowest_settle_s) slowest_settle_s = settle_s;
+         }
+         all_settled = all_settled && settled;
+     }
+     servo_set_position(0.0f);
+     if (all_settled) {
+         servo_set_travel_time_s(slowest_settle_s);
+         config_store_set_float(CONFIG_KEY_SERVO_TRAVEL_TIME_S, slowest_settle_s);
+         printf("Flip lead set to %.0f ms\n", slowest_settle_s * 1000.0f);
+     }
+     menu_display_main();
+ }
+
 
  // --- Simulation Action Implementations ---
 
@@ -209,6 +327,7 @@
      std::cout << "\n--- Load Simulation File ---" << std::endl;
 
      if (!sd_is_mounted()) { std::cout << "Error: SD Card not mounted...\n"; menu_display_main(); return; } // [cite: uploaded:my_projects/SerialMenu.cpp]
+     if (motor_get_state() != MOTOR_STOPPED) { std::cout << "Error: Stop the motor before loading a profile (flash writes pause it).\n"; menu_display_main(); return; }
 
      // List CSV Files
      std::vector<std::string> csv_files = sd_list_files("", ".csv"); // [cite: uploaded:my_projects/SerialMenu.cpp]
@@ -231,23 +350,11 @@
          } else { std::cout << "Invalid choice...\n"; } // [cite: uploaded:my_projects/SerialMenu.cpp]
      }
 
-     // Store selected file to Flash
-     std::cout << "Storing '" << selected_filename << "' to Flash..." << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
-     if (!store_openrocket_to_flash(selected_filename.c_str())) { std::cout << "FAILED to store to flash...\n"; menu_display_main(); return; } // [cite: uploaded:my_projects/SerialMenu.cpp]
-     std::cout << "Successfully stored to flash." << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
-
-     // Read back from Flash
-     size_t stored_size = get_stored_data_size_from_flash(); // [cite: uploaded:my_projects/SerialMenu.cpp]
-     if (stored_size == 0) { std::cout << "Error: Stored size is 0...\n"; menu_display_main(); return; } // [cite: uploaded:my_projects/SerialMenu.cpp]
-     char* data_buffer = (char*)malloc(stored_size); // [cite: uploaded:my_projects/SerialMenu.cpp]
-     if (!data_buffer) { std::cout << "Error: Failed to allocate buffer...\n"; menu_display_main(); return; } // [cite: uploaded:my_projects/SerialMenu.cpp]
-     int bytes_read = read_openrocket_from_flash(data_buffer, stored_size); // [cite: uploaded:my_projects/SerialMenu.cpp]
-     if (bytes_read <= 0 || (size_t)bytes_read != stored_size) { std::cout << "Error reading back from flash...\n"; free(data_buffer); menu_display_main(); return; } // [cite: uploaded:my_projects/SerialMenu.cpp]
-
-     // Parse the data
-     bool parse_success = parse_openrocket_data(data_buffer, bytes_read); // [cite: uploaded:my_projects/SerialMenu.cpp]
+     // Parse straight from SD (no copy of the CSV anywhere)
+     uint64_t parse_start_us = time_us_64();
+     bool parse_success = load_openrocket_from_sd(selected_filename.c_str());
+     printf("Parsed in %.1f ms\n", (time_us_64() - parse_start_us) / 1000.0f);
      size_t point_count_after_parse = get_parsed_data_count(); // [cite: uploaded:my_projects/SerialMenu.cpp]
-     free(data_buffer); // Free buffer now [cite: uploaded:my_projects/SerialMenu.cpp]
      if (!parse_success || point_count_after_parse == 0) { std::cout << "Warning: Parsing failed or yielded zero points...\n"; menu_display_main(); return; } // [cite: uploaded:my_projects/SerialMenu.cpp]
 
      // Get Configured Radius
@@ -260,37 +367,69 @@
      if (!calc_success) { printf("Warning: Failed to calculate target PPS values.\n"); } // [cite: uploaded:my_projects/SerialMenu.cpp]
 
      size_t final_point_count = get_parsed_data_count(); // [cite: uploaded:my_projects/SerialMenu.cpp]
+     size_t flips = flip_schedule_build(); // Servo flips at the G zero crossings
+
+     // Compile into the binary profile the run reads in place
+     bool stored = calc_success && store_profile_to_flash(selected_filename.c_str(), radius_cm);
+     release_parsed_data();
+     if (!stored) { std::cout << "FAILED to store the profile to flash...\n"; menu_display_main(); return; }
      std::cout << "Load process complete for '" << selected_filename << "'. Points: " << final_point_count << std::endl; // [cite: uploaded:my_projects/SerialMenu.cpp]
+     printf("Servo flips: %u (sign must hold %.0f ms)\n", (unsigned int)flips, FLIP_DEBOUNCE_S * 1000.0f);
 
      menu_display_main(); // Show main menu again [cite: uploaded:my_projects/SerialMenu.cpp]
  }
 
+ /**
+  * @brief Commands the scheduled flips whose command time (crossing minus lead) has come.
+  * @return Index of the next flip still to command.
+  */
+ static size_t menu_service_flips(const ProfileFlip* flips, size_t next_flip, size_t flip_count,
+                                  int64_t now_us, int64_t lead_us, float* servo_target) {
+     while (next_flip < flip_count) {
+         const ProfileFlip& flip = flips[next_flip];
+         if ((int64_t)flip.crossing_us - lead_us > now_us) {
+             break;
+         }
+         *servo_target = flip.position;
+         servo_set_position(flip.position); // Returns at once; no print per flip
+         next_flip++;
+     }
+     return next_flip;
+ }
+
  /**
   * @brief Runs the loaded simulation profile, including servo control.
   */
  void menu_run_simulation() { // [cite: uploaded:my_projects/SerialMenu.cpp]
     printf("\n--- Initializing Simulation Run ---\n");
 
-    // 1. Check if data is loaded
-    size_t point_count = get_parsed_data_count(); // [cite: uploaded:my_projects/SerialMenu.cpp]
-    if (point_count == 0) { // [cite: uploaded:my_projects/SerialMenu.cpp]
-        printf("Error: No parsed simulation data available. Load data first ('l').\n");
+    // 1. Check if a profile is stored; it is read in place from flash
+    const ProfileHeader* profile = get_profile_header();
+    if (!profile) {
+        printf("Error: No simulation profile in flash. Load data first ('l').\n");
         menu_display_main(); // Display main menu [cite: uploaded:my_projects/SerialMenu.cpp]
         return;
     }
+    if (fabsf(profile->radius_cm - s_configured_radius_cm) > 0.005f) {
+        // The PPS values are only right for the radius they were computed for
+        printf("Error: Profile was compiled for a %.2f cm radius, but %.2f cm is configured. Reload it ('l').\n",
+               profile->radius_cm, s_configured_radius_cm);
+        menu_display_main();
+        return;
+    }
+    const size_t point_count = profile->point_count;
+    const ProfilePoint* points = get_profile_points();
 
     // --- 2. Initialize Servo State Tracking ---
+    // Flips were found at load time; each is commanded one servo travel time early
     float target_servo_state_position = 0.0f; // Servo starts (and represents) position 0.0 [cite: uploaded:my_projects/SerialMenu.cpp]
-    int previous_acceleration_sign = 1;  // Assume initially corresponds to positive G (matching 0.0 state) [cite: uploaded:my_projects/SerialMenu.cpp]
-    int flip_cooldown_counter = 0;      // Cooldown after flipping [cite: uploaded:my_projects/SerialMenu.cpp]
-
-    FlightDataPoint first_point = get_parsed_data_point(0); // Need first point info [cite: uploaded:my_projects/SerialMenu.cpp]
-    if (first_point.acceleration >= 0) { // [cite: uploaded:my_projects/SerialMenu.cpp]
-         previous_acceleration_sign = 1; // [cite: uploaded:my_projects/SerialMenu.cpp]
-    } else {
-         previous_acceleration_sign = -1; // [cite: uploaded:my_projects/SerialMenu.cpp]
-    }
-    printf("Servo starting at position 0.0 (set by init). Primed initial sign state. Starting simulation...\n"); // [cite: uploaded:my_projects/SerialMenu.cpp]
+    const size_t flip_count = profile->flip_count;
+    const ProfileFlip* flips = get_profile_flips();
+    const float flip_lead_s = servo_get_travel_time_s();
+    const int64_t flip_lead_us = (int64_t)(flip_lead_s * 1e6f);
+    size_t next_flip = 0;
+    printf("Servo starting at position 0.0 (set by init). %u flip(s) scheduled %.0f ms ahead. Starting simulation...\n",
+           (unsigned int)flip_count, flip_lead_s * 1000.0f);
 
 
     // --- 3. Start Simulation Timing ---
@@ -298,43 +437,35 @@
     bool stopped = false; // [cite: uploaded:my_projects/SerialMenu.cpp]
 
     // --- 4. Main Simulation Loop ---
-    printf("Timestamp (s), Target PPS (Hz), Servo State (0/1)\n"); // Header for runtime data [cite: uploaded:my_projects/SerialMenu.cpp]
+    motor_reset_tracking_stats();
+    // Achieved G comes from the encoder speed if there is one, otherwise from the
+    // steps actually output between rows; never from the commanded rate
+    const float radius_m = s_configured_radius_cm / 100.0f;
+    const bool use_encoder = motor_has_encoder();
+    const uint32_t stalls_at_start = motor_get_stall_count();
+    MotorOdometry previous_odometry = motor_get_odometry();
+    printf("Timestamp (s), Target PPS (Hz), Actual PPS (Hz), Tracking Error (PPS), Achieved G, Servo Target (0/1), Servo Output\n"); // Header for runtime data
     for (size_t i = 0; i < point_count && !stopped; ++i) { // [cite: uploaded:my_projects/SerialMenu.cpp]
-        FlightDataPoint point = get_parsed_data_point(i); // [cite: uploaded:my_projects/SerialMenu.cpp]
+        const ProfilePoint& point = points[i];
+        const float point_s = point.time_us * 1e-6f; // For printing
 
         // --- 4a. Servo Flip Logic ---
-        int current_acceleration_sign = (point.acceleration > 0.001f) ? 1 : ((point.acceleration < -0.001f) ? -1 : 0); // Check sign with tolerance [cite: uploaded:my_projects/SerialMenu.cpp]
-
-        if (flip_cooldown_counter > 0) { // [cite: uploaded:my_projects/SerialMenu.cpp]
-            flip_cooldown_counter--; // Decrement cooldown [cite: uploaded:my_projects/SerialMenu.cpp]
-        } else {
-            // Check for sign change [cite: uploaded:my_projects/SerialMenu.cpp]
-            if (current_acceleration_sign != 0 && previous_acceleration_sign != 0 && current_acceleration_sign != previous_acceleration_sign) {
-                printf("\nSIGN CHANGE DETECTED at t=%.3f (%.3f G -> %.3f G)! Flipping servo.\n", // [cite: uploaded:my_projects/SerialMenu.cpp]
-                       point.timestamp, (i > 0 ? get_parsed_data_point(i-1).acceleration : first_point.acceleration), point.acceleration);
-
-                // Flip target position state [cite: uploaded:my_projects/SerialMenu.cpp]
-                target_servo_state_position = (target_servo_state_position == 0.0f) ? 1.0f : 0.0f;
-                servo_set_position(target_servo_state_position); // Command the move [cite: uploaded:my_projects/SerialMenu.cpp]
-                flip_cooldown_counter = 3; // Start cooldown [cite: uploaded:my_projects/SerialMenu.cpp]
-            }
-        }
-        // Update previous sign [cite: uploaded:my_projects/SerialMenu.cpp]
-        if (current_acceleration_sign != 0) {
-            previous_acceleration_sign = current_acceleration_sign; // [cite: uploaded:my_projects/SerialMenu.cpp]
-        }
+        // Flips due by this point's time (also serviced while waiting, below)
+        next_flip = menu_service_flips(flips, next_flip, flip_count, point.time_us, flip_lead_us, &target_servo_state_position);
 
 
         // --- 4b. Timing Logic & Wait ---
         absolute_time_t current_time = get_absolute_time(); // [cite: uploaded:my_projects/SerialMenu.cpp]
         int64_t elapsed_us = absolute_time_diff_us(start_time, current_time); // [cite: uploaded:my_projects/SerialMenu.cpp]
-        int64_t target_us = (int64_t)(point.timestamp * 1000000.0f); // [cite: uploaded:my_projects/SerialMenu.cpp]
+        int64_t target_us = point.time_us;
         int64_t delay_us = target_us - elapsed_us; // [cite: uploaded:my_projects/SerialMenu.cpp]
 
         // Wait if needed, checking for stop command [cite: uploaded:my_projects/SerialMenu.cpp]
         if (delay_us > 1000) { // [cite: uploaded:my_projects/SerialMenu.cpp]
             absolute_time_t wait_until_time = delayed_by_us(current_time, delay_us); // [cite: uploaded:my_projects/SerialMenu.cpp]
             while (absolute_time_diff_us(get_absolute_time(), wait_until_time) > 0 && !stopped) { // [cite: uploaded:my_projects/SerialMenu.cpp]
+                int64_t now_us = absolute_time_diff_us(start_time, get_absolute_time());
+                next_flip = menu_service_flips(flips, next_flip, flip_count, now_us, flip_lead_us, &target_servo_state_position);
                 int c = getchar_timeout_us(100); // Check for stop input non-blockingly [cite: uploaded:my_projects/SerialMenu.cpp]
                 if (c == 's' || c == 'S') { // [cite: uploaded:my_projects/SerialMenu.cpp]
                     printf("\nStop requested by user.\n");
@@ -346,15 +477,29 @@
             }
             if (stopped) break; // Exit outer simulation loop if stopped during wait [cite: uploaded:my_projects/SerialMenu.cpp]
         } else if (delay_us < -15000) { // Check if lagging [cite: uploaded:my_projects/SerialMenu.cpp]
-            printf("Warning: Simulation lagging at point %u (Target Time %.3f s)\n", (unsigned int)i, point.timestamp); // [cite: uploaded:my_projects/SerialMenu.cpp]
+            printf("Warning: Simulation lagging at point %u (Target Time %.3f s)\n", (unsigned int)i, point_s); // [cite: uploaded:my_projects/SerialMenu.cpp]
         }
 
 
         // --- 4c. Command the Motor ---
+        if (motor_get_stall_count() != stalls_at_start) {
+            // The motor core has already stopped and released the motor; don't restart it
+            printf("\nMotor stalled at t=%.3f s, aborting simulation.\n", point_s);
+            stopped = true;
+            break;
+        }
         // Print current state for this timestamp
-        printf("%.3f, %.3f, %.1f\n", // [cite: uploaded:my_projects/SerialMenu.cpp]
-               point.timestamp, point.target_pps, target_servo_state_position); // Use state tracking variable [cite: uploaded:my_projects/SerialMenu.cpp]
         motor_set_target_frequency(point.target_pps); // Set motor speed [cite: uploaded:my_projects/SerialMenu.cpp]
+        MotorOdometry odometry = motor_get_odometry();
+        float omega = motor_odometry_angular_velocity(previous_odometry, odometry);
+        previous_odometry = odometry;
+        if (use_encoder) {
+            omega = motor_get_measured_pps() * (2.0f * (float)M_PI / (float)motor_get_steps_per_rev());
+        }
+        printf("%.3f, %.3f, %d, %.1f, %.2f, %.1f, %.2f\n",
+               point_s, point.target_pps, motor_get_current_pps(), motor_get_tracking_error(),
+               omega * omega * radius_m / STANDARD_GRAVITY,
+               target_servo_state_position, servo_get_position()); // Use state tracking variable [cite: uploaded:my_projects/SerialMenu.cpp]
 
     } // End main simulation loop [cite: uploaded:my_projects/SerialMenu.cpp]
 
@@ -363,13 +508,13 @@
     if (!stopped) { // [cite: uploaded:my_projects/SerialMenu.cpp]
          printf("\nSimulation finished normally.\n");
     }
-    motor_set_target_frequency(0.0f); // Ensure motor is stopped [cite: uploaded:my_projects/SerialMenu.cpp]
+    printf("Peak tracking error: %.1f PPS\n", motor_get_peak_tracking_error());
+    motor_set_target_frequency(0.0f); // Ramp the motor down to a stop [cite: uploaded:my_projects/SerialMenu.cpp]
 
     // Return servo to default position 0.0
     printf("Returning servo to default position 0.0...\n"); // [cite: uploaded:my_projects/SerialMenu.cpp]
     // Note: Previous version set to 1.0, but 0.0 seems more standard 'default'
-    servo_set_position(0.0f); // <<< Changed to 0.0
-    sleep_ms(1000); // Wait long enough for potential full travel [cite: uploaded:my_projects/SerialMenu.cpp]
+    servo_set_position(0.0f); // <<< Changed to 0.0; the motion engine finishes the move in the background
 
     menu_display_main(); // Display main menu [cite: uploaded:my_projects/SerialMenu.cpp]
 }
@@ -390,10 +535,86 @@
               }
               s_configured_radius_cm = new_radius; // Store [cite: uploaded:my_projects/SerialMenu.cpp]
               printf("Radius set to %.2f cm\n", s_configured_radius_cm); // [cite: uploaded:my_projects/SerialMenu.cpp]
+              config_store_set_float(CONFIG_KEY_RADIUS_CM, s_configured_radius_cm);
               menu_display_config(); // Show updated config menu [cite: uploaded:my_projects/SerialMenu.cpp]
              break;
          }
-         // Add cases '2', '3' etc. for future settings
+         case '2': case '3': case '4': { // Motion limits for planned ramps
+             const char* prompt = (cmd == '2') ? "Enter max accel (PPS/s, > 0): "
+                                : (cmd == '3') ? "Enter max decel (PPS/s, > 0): "
+                                               : "Enter max jerk (PPS/s^2, > 0): ";
+             float value = menu_read_float(prompt);
+             if (value <= 0.0f) {
+                 std::cout << "Invalid value, keeping current setting.\n";
+             } else {
+                 motor_set_motion_limits(cmd == '2' ? value : 0.0f,
+                                         cmd == '3' ? value : 0.0f,
+                                         cmd == '4' ? value : 0.0f);
+             }
+             menu_display_config();
+             break;
+         }
+         case '5': { // Odometry scale
+             float value = menu_read_float("Enter steps per revolution (> 0): ");
+             if (value < 1.0f) {
+                 std::cout << "Invalid value, keeping current setting.\n";
+             } else {
+                 motor_set_steps_per_rev((uint32_t)(value + 0.5f));
+             }
+             menu_display_config();
+             break;
+         }
+         case '6': { // Resonance band slot
+             float slot = menu_read_float("Enter band number (1-4): ");
+             int index = (int)(slot + 0.5f) - 1;
+             if (index < 0 || index >= PLANNER_MAX_BANDS) {
+                 std::cout << "Invalid band number.\n";
+             } else {
+                 float low = menu_read_float("Enter band low edge (PPS): ");
+                 float high = menu_read_float("Enter band high edge (PPS, <= low clears the band): ");
+                 motor_set_resonance_band(index, low, high);
+             }
+             menu_display_config();
+             break;
+         }
+         case '7': { // Servo motion engine limits
+             float speed = menu_read_float("Enter servo max speed (full travel per s, 0 = unlimited): ");
+             float accel = menu_read_float("Enter servo max accel (full travel per s^2, 0 = unlimited): ");
+             if (speed < 0.0f || accel < 0.0f) {
+                 std::cout << "Invalid value, keeping current setting.\n";
+             } else {
+                 servo_set_motion_limits(speed, accel);
+             }
+             menu_display_config();
+             break;
+         }
+         case '8': { // Flip lead
+             float value = menu_read_float("Enter servo travel time (ms, >= 0): ");
+             if (value < 0.0f) {
+                 std::cout << "Invalid value, keeping current setting.\n";
+             } else {
+                 servo_set_travel_time_s(value / 1000.0f);
+                 config_store_set_float(CONFIG_KEY_SERVO_TRAVEL_TIME_S, servo_get_travel_time_s());
+             }
+             menu_display_config();
+             break;
+         }
+         case '9': { // Servo PWM frame rate
+             float value = menu_read_float("Enter servo frame rate (Hz, 40-333; above 50 for digital servos only): ");
+             servo_set_frame_rate_hz(value); // Prints why if it refuses
+             menu_display_config();
+             break;
+         }
+         case 'c': case 'C': { // CSV columns, by header name (used by the next load)
+             std::string time_column = menu_read_text("Enter time column name (Enter keeps it): ");
+             std::string accel_column = menu_read_text("Enter acceleration column name (Enter keeps it): ");
+             if (time_column.empty()) time_column = get_openrocket_time_column();
+             if (accel_column.empty()) accel_column = get_openrocket_acceleration_column();
+             set_openrocket_columns(time_column.c_str(), accel_column.c_str());
+             menu_display_config();
+             break;
+         }
+         // Add cases for future settings here
 
          case 'b': case 'B': case 'q': case 'Q': // Back/Quit [cite: uploaded:my_projects/SerialMenu.cpp]
               s_currentMenuState = MENU_STATE_MAIN; // Change state back [cite: uploaded:my_projects/SerialMenu.cpp]
@@ -441,10 +662,21 @@
               s_currentMenuState = MENU_STATE_CONFIG; // [cite: uploaded:my_projects/SerialMenu.cpp]
               menu_display_config(); // [cite: uploaded:my_projects/SerialMenu.cpp]
               break;
+         // Step timing instrumentation
+         case 'j': case 'J':
+             motor_set_edge_capture(!motor_is_edge_capture_enabled());
+             std::cout << "\nStep jitter capture " << (motor_is_edge_capture_enabled() ? "armed (cleared)." : "stopped.") << std::endl;
+             break;
+         case 'h': case 'H':
+             motor_report_edge_jitter();
+             break;
         //Servo
          case 'v': case 'V': // <<< UPDATED CASE
              menu_servo_calibrate(); // <<< CALL NEW FUNCTION
              break; // Servo calibrate handles redisplaying menu
+         case 'a': case 'A':
+             menu_servo_latency();
+             break;
          // General
          case 'm': case 'M': case '?': menu_display_main(); break; // [cite: uploaded:my_projects/SerialMenu.cpp]
          // Ignore Enter
@@ -14,6 +14,11 @@ typedef enum {
 
 // --- Public Function Declarations ---
 
+/**
+ * @brief Loads the menu's saved settings (radius). Call after config_store_init().
+ */
+void menu_init();
+
 /**
  * @brief Displays the main command menu.
  */
@@ -49,6 +54,12 @@ void menu_run_simulation(); // [cite: uploaded:my_projects/SerialMenu.h]
  */
 void menu_servo_calibrate();
 
+/**
+ * @brief Measures the servo's actuation latency with the feedback pot and
+ * adopts the slower settle time as the flip lead.
+ */
+void menu_servo_latency();
+
 
 // --- Configuration Accessor ---
 /**
@@ -1,273 +1,251 @@
 #include "StepperMotor.h"
-#include "hardware/gpio.h"
-#include "hardware/timer.h"
-#include <iostream> // For error messages/state changes
-#include <cmath>    // For floorf
-
-// --- Module-Internal Configuration ---
-const uint STEP_PIN = 0;  // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-const uint DIR_PIN = 1;   // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-const uint ENABLE_PIN = 2; // Active LOW enable [cite: uploaded:my_projects/StepperMotor.cpp]
-
-// Configuration for the test run ('t' command)
-const int TARGET_PPS = 1200;       // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-const int START_PPS = 100;         // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-const int ACCEL_STEP_PPS = 20;     // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-const int DECEL_STEP_PPS = 50;     // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
+#include "StepperMotorAxis.h"
+#include "pico/multicore.h"
+#include <atomic>
+#include <iostream> // For the startup message
+#include <cmath>    // For lroundf
+
+// --- Axis Configuration ---
+
+// Centrifuge arm: instance 0, behind the motor_* functions
+struct MainAxisConfig {
+    static constexpr uint STEP_PIN = 0;    // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
+    static constexpr uint DIR_PIN = 1;     // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
+    static constexpr uint ENABLE_PIN = 2;  // Active LOW enable [cite: uploaded:my_projects/StepperMotor.cpp]
+    static constexpr bool STEP_INVERTED = false;
+    static constexpr bool ENABLE_ACTIVE_LOW = true;
+    static constexpr bool DIR_FORWARD_HIGH = true;
+
+    // Step generation backend: PIO state machine (CPU only pushes period words) or
+    // the edge alarm toggle ISR. Falls back to the alarm if no PIO SM is free.
+    static constexpr bool USE_PIO_STEP_ENGINE = true;
+    static constexpr float STEP_PULSE_HIGH_US = 5.0f;
+
+    // Configuration for the test run ('t' command)
+    static constexpr float TEST_TARGET_PPS = 1200.0f; // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
+    static constexpr float START_PPS = 100.0f;        // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
+    // The test ramp is played from a compile-time table: about 12.2k pulses (1/16
+    // step up to 1188 PPS), 61 KB of flash. See ramp_table.h.
+    static constexpr bool TEST_RAMP_TABLE = true;
+
+    // Default motion limits for planned ramps (adjustable via motor_set_motion_limits)
+    static constexpr float MAX_ACCEL_PPS2 = 1000.0f;  // Same average ramp as the old 20 PPS per 20 ms tick
+    static constexpr float MAX_DECEL_PPS2 = 2500.0f;  // Same as the old 50 PPS per 20 ms tick
+    static constexpr float MAX_JERK_PPS3 = 5000.0f;   // Reaches full accel in 0.2 s
+
+    // Full steps per output revolution for the odometry (200 matches RPM = PPS * 0.3 in the profile mapping)
+    static constexpr uint32_t STEPS_PER_REV = 200;
+
+    // A4988-style MS1..MS3 decoding, finest first. Low speeds run at 1/16 step for
+    // smooth motion; above MAX_PULSE_PPS the driver drops to coarser modes, so high
+    // speeds need no higher STEP rate (or interrupt rate on the timer backend).
+    static constexpr MicrostepMode MICROSTEP_MODES[] = {
+        {16, 0b111}, {8, 0b011}, {4, 0b010}, {2, 0b001}, {1, 0b000}
+    };
+    static constexpr uint MS1_PIN = 6;
+    static constexpr uint MS2_PIN = 7;
+    static constexpr uint MS3_PIN = 8;
+    static constexpr float MAX_PULSE_PPS = 20000.0f;
+    // The alarm backend takes an interrupt per edge, so without the PIO engine the
+    // STEP rate stays at the full-step test target (2400 interrupts/s at most)
+    static constexpr float MAX_TIMER_PULSE_PPS = 1200.0f;
+
+    // Optional shaft encoder (A on GPIO 9, B on GPIO 10) for the speed loop and stall
+    // detection. Enable once it is fitted: with no encoder the counts stay at zero,
+    // which would read as a stall on the first run.
+    static constexpr bool ENCODER_ENABLED = false;
+    static constexpr uint ENCODER_PIN_A = 9;
+    static constexpr uint32_t ENCODER_COUNTS_PER_REV = 2400; // 600 lines, 4x decoding
+
+    static constexpr bool EDGE_CAPTURE = true;
+    static constexpr const char* LABEL = "";
+};
+
+// The tilt axis only claims its pins and a state machine when enabled
+constexpr bool ENABLE_TILT_AXIS = false;
+
+// Tilt table: second axis on its own PIO state machine (or alarm)
+struct TiltAxisConfig {
+    static constexpr uint STEP_PIN = 3;
+    static constexpr uint DIR_PIN = 4;
+    static constexpr uint ENABLE_PIN = 5;
+    static constexpr bool STEP_INVERTED = false;
+    static constexpr bool ENABLE_ACTIVE_LOW = true;
+    static constexpr bool DIR_FORWARD_HIGH = true;
+    static constexpr bool USE_PIO_STEP_ENGINE = true;
+    static constexpr float STEP_PULSE_HIGH_US = 5.0f;
+    static constexpr float TEST_TARGET_PPS = 400.0f;
+    static constexpr float START_PPS = 50.0f;
+    static constexpr float MAX_ACCEL_PPS2 = 500.0f;
+    static constexpr float MAX_DECEL_PPS2 = 1000.0f;
+    static constexpr float MAX_JERK_PPS3 = 2500.0f;
+    static constexpr uint32_t STEPS_PER_REV = 200;
+    static constexpr MicrostepMode MICROSTEP_MODES[] = {{1, 0b000}}; // MS pins strapped on the board
+    static constexpr bool ENCODER_ENABLED = false;
+    static constexpr bool TEST_RAMP_TABLE = ENABLE_TILT_AXIS; // No flash for an axis that isn't fitted
+    static constexpr bool EDGE_CAPTURE = false;
+    static constexpr const char* LABEL = "Tilt ";
+};
+
+// Motor core (core1) loop period: bounds command latency and the snapshot refresh rate
+const uint32_t MOTOR_CORE_POLL_US = 50;
+const uint MOTOR_ALARM_POOL_SIZE = 4; // One edge alarm per axis on the alarm backend
 
 // --- Module-Internal State Variables (Encapsulated) ---
-static volatile MotorState s_currentState = MOTOR_STOPPED;     // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-static volatile int s_currentPPS = 0;                          // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-static volatile bool s_stepPinState = false;                   // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-static struct repeating_timer s_stepTimer;                     // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-static volatile bool s_timerActive = false;                    // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
+static StepperMotor<MainAxisConfig> s_mainAxis;
+static StepperMotor<TiltAxisConfig> s_tiltAxis;
+static std::atomic<bool> s_motorCoreReady{false}; // Set once core1 owns the hardware
 
 // --- Module-Internal Helper Function Declarations ---
-static bool step_timer_callback(struct repeating_timer *t);    // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-static int64_t pps_to_delay_us(int pps);                       // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-static void start_step_timer(int pps);                         // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-static void stop_step_timer();                                 // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
+static void motor_core_entry();
 
 // --- Public Function Implementations ---
 
 void motor_init() {                                           // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-    // Initialize Stepper GPIO pins
-    gpio_init(STEP_PIN);
-    gpio_init(DIR_PIN);
-    gpio_init(ENABLE_PIN);
-    gpio_set_dir(STEP_PIN, GPIO_OUT);
-    gpio_set_dir(DIR_PIN, GPIO_OUT);
-    gpio_set_dir(ENABLE_PIN, GPIO_OUT);
-
-    // Set initial motor hardware state
-    gpio_put(DIR_PIN, 1);    // Set default direction
-    gpio_put(ENABLE_PIN, 1); // Start disabled
-    gpio_put(STEP_PIN, 0);   // Ensure step pin is low
-    sleep_ms(10); // Allow driver to settle
-
-    // Initialize internal state variables
-    s_currentState = MOTOR_STOPPED;
-    s_currentPPS = 0;
-    s_timerActive = false;
-    s_stepPinState = false;
-}
+    s_mainAxis.console_init();
+    s_tiltAxis.console_init();
 
-// *** MODIFIED motor_update_state ***
-void motor_update_state() {
-    bool speedChanged = false;
-
-    switch (s_currentState) {
-        case MOTOR_ACCELERATING:                                // Logic from original file [cite: uploaded:my_projects/StepperMotor.cpp]
-            if (s_currentPPS < TARGET_PPS) {
-                s_currentPPS += ACCEL_STEP_PPS;
-                if (s_currentPPS > TARGET_PPS) {
-                    s_currentPPS = TARGET_PPS;
-                }
-                speedChanged = true;
-            } else {
-                s_currentPPS = TARGET_PPS;
-                s_currentState = MOTOR_RUNNING;
-                speedChanged = true; // Update timer to exact target freq
-                std::cout << "State: RUNNING at " << s_currentPPS << " PPS" << std::endl;
-            }
-            break;
-
-        case MOTOR_DECELERATING:                                // Logic modified slightly from original [cite: uploaded:my_projects/StepperMotor.cpp]
-            if (s_currentPPS > 0) {
-                s_currentPPS -= DECEL_STEP_PPS;
-                 if (s_currentPPS <= 0) {
-                    s_currentPPS = 0;
-                    // State change now handled below
-                 }
-                speedChanged = true; // Speed potentially changed
-
-                // Check if deceleration resulted in zero speed
-                if (s_currentPPS == 0 && s_currentState != MOTOR_STOPPED) {
-                    s_currentState = MOTOR_STOPPED;
-                    stop_step_timer();
-                    gpio_put(ENABLE_PIN, 1); // Disable motor driver
-                    std::cout << "State: STOPPED" << std::endl;
-                    speedChanged = false; // Speed is now 0, no timer update needed
-                }
-            } else { // Should already be 0 PPS if decelerating
-                 if (s_currentState != MOTOR_STOPPED) {
-                     s_currentState = MOTOR_STOPPED;
-                     stop_step_timer();
-                     gpio_put(ENABLE_PIN, 1);
-                     std::cout << "State: STOPPED (from zero check)" << std::endl;
-                 }
-                 // Ensure timer/enable are correct if somehow missed
-                 if (s_timerActive) stop_step_timer();
-                 if (gpio_get(ENABLE_PIN) == 0) gpio_put(ENABLE_PIN, 1);
-            }
-            break;
-
-        case MOTOR_RUNNING:                                     // Logic from original file [cite: uploaded:my_projects/StepperMotor.cpp]
-            // State change initiated externally by motor_stop_test()
-            // Or maybe by motor_set_target_frequency(0)?
-            break;
-
-        // *** ADDED Case for MOTOR_SIMULATING ***
-        case MOTOR_SIMULATING:
-            // Speed is controlled directly by motor_set_target_frequency.
-            // motor_update_state does nothing in this state regarding speed.
-            speedChanged = false;
-            break;
-
-        case MOTOR_STOPPED:                                     // Logic from original file [cite: uploaded:my_projects/StepperMotor.cpp]
-            // State change initiated externally
-            // Ensure motor remains disabled and timer stopped
-            if (gpio_get(ENABLE_PIN) == 0 || s_timerActive) {
-                gpio_put(ENABLE_PIN, 1);
-                stop_step_timer();
-            }
-            break;
+    // Core1 sets up the pins and step backends itself so their interrupts run there
+    multicore_launch_core1(motor_core_entry);
+    while (!s_motorCoreReady.load(std::memory_order_acquire)) {
+        tight_loop_contents();
     }
 
-    // Only update timer if speed changed during ACCEL/DECEL phases
-    if (speedChanged && (s_currentState == MOTOR_ACCELERATING || s_currentState == MOTOR_DECELERATING)) {
-         start_step_timer(s_currentPPS);
+    if (s_mainAxis.uses_pio()) {
+        std::cout << "Step engine: PIO (core1)" << std::endl;
+    } else {
+        std::cout << "Step engine: repeating timer (core1)" << std::endl;
+    }
+    if (ENABLE_TILT_AXIS) {
+        std::cout << "Tilt axis: " << (s_tiltAxis.uses_pio() ? "PIO" : "repeating timer") << std::endl;
     }
 }
 
-void motor_start_test() {                                      // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-    if (s_currentState == MOTOR_STOPPED) {
-        std::cout << "Starting Motor Test..." << std::endl;
-        s_currentState = MOTOR_ACCELERATING;
-        s_currentPPS = START_PPS;
-        gpio_put(ENABLE_PIN, 0); // Enable motor driver
-        start_step_timer(s_currentPPS);
-        std::cout << "State: ACCELERATING" << std::endl;
-    } else {
-        std::cout << "Motor is not stopped. Use 's' to stop first." << std::endl;
+void motor_update_state() {
+    s_mainAxis.update_state();
+    if (ENABLE_TILT_AXIS) {
+        s_tiltAxis.update_state();
     }
 }
 
-// *** MODIFIED motor_stop_test ***
+void motor_start_test() {                                      // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
+    s_mainAxis.start_test();
+}
+
 void motor_stop_test() {                                      // Modified from original [cite: uploaded:my_projects/StepperMotor.cpp]
-    // Now also handles stopping from SIMULATING state
-    if (s_currentState == MOTOR_RUNNING || s_currentState == MOTOR_ACCELERATING || s_currentState == MOTOR_SIMULATING) {
-        std::cout << "Stopping Motor..." << std::endl;
-        // If simulating, just set speed to 0 directly. If test run, decelerate.
-        if (s_currentState == MOTOR_SIMULATING) {
-            motor_set_target_frequency(0.0f); // Go directly to 0 PPS and STOPPED state
-            // The state change message happens inside motor_set_target_frequency
-        } else {
-             s_currentState = MOTOR_DECELERATING; // Initiate test run deceleration
-             std::cout << "State: DECELERATING" << std::endl;
-        }
-    } else if (s_currentState == MOTOR_STOPPED) {
-         std::cout << "Motor is already stopped." << std::endl;
-    } else { // Already decelerating
-        std::cout << "Motor is already stopping." << std::endl;
-    }
+    s_mainAxis.stop();
 }
 
 MotorState motor_get_state() {                                // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-    return s_currentState;
+    return s_mainAxis.get_state();
+}
+
+void motor_set_motion_limits(float max_accel_pps2, float max_decel_pps2, float max_jerk_pps3) {
+    s_mainAxis.set_motion_limits(max_accel_pps2, max_decel_pps2, max_jerk_pps3);
+}
+
+MotionLimits motor_get_motion_limits() {
+    return s_mainAxis.get_motion_limits();
+}
+
+bool motor_set_resonance_band(int index, float low_pps, float high_pps) {
+    return s_mainAxis.set_resonance_band(index, low_pps, high_pps);
+}
+
+void motor_print_band_report() {
+    s_mainAxis.print_band_report();
 }
 
 int motor_get_current_pps() {                                 // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-    return s_currentPPS;
+    return (int)lroundf(s_mainAxis.get_current_pps());
+}
+
+uint64_t motor_get_step_count() {
+    return s_mainAxis.get_step_count();
+}
+
+uint16_t motor_get_microsteps() {
+    return s_mainAxis.get_microsteps();
+}
+
+bool motor_has_encoder() {
+    return s_mainAxis.has_encoder();
+}
+
+float motor_get_measured_pps() {
+    return s_mainAxis.get_measured_pps();
+}
+
+uint32_t motor_get_stall_count() {
+    return s_mainAxis.get_stall_count();
+}
+
+MotorOdometry motor_get_odometry() {
+    return s_mainAxis.get_odometry();
+}
+
+void motor_set_steps_per_rev(uint32_t steps_per_rev) {
+    s_mainAxis.set_steps_per_rev(steps_per_rev);
+}
+
+uint32_t motor_get_steps_per_rev() {
+    return s_mainAxis.get_steps_per_rev();
+}
+
+float motor_odometry_angular_velocity(const MotorOdometry& from, const MotorOdometry& to) {
+    return s_mainAxis.odometry_angular_velocity(from, to);
 }
 
-// *** ADDED Implementation for motor_set_target_frequency ***
-/**
- * @brief Sets the target rotational frequency for the motor directly.
- */
 void motor_set_target_frequency(float pps) {
-    int target_pps_int = static_cast<int>(floorf(pps + 0.5f)); // Round to nearest int
+    s_mainAxis.set_target_frequency(pps);
+}
 
-    if (target_pps_int < 0) {
-        target_pps_int = 0;
-    }
+float motor_get_tracking_error() {
+    return s_mainAxis.get_tracking_error();
+}
 
-    // Check if the target integer PPS requires a state/timer change
-    bool needs_update = false;
-    if (target_pps_int != s_currentPPS) needs_update = true;
-    if (target_pps_int > 0 && s_currentState == MOTOR_STOPPED) needs_update = true;
-    if (target_pps_int == 0 && s_currentState != MOTOR_STOPPED) needs_update = true;
-
-    if (needs_update) {
-        s_currentPPS = target_pps_int; // Update internal PPS tracking
-
-        if (s_currentPPS > 0) {
-            // If stopped, enable motor and set state before starting timer
-            if (s_currentState == MOTOR_STOPPED) {
-                 std::cout << "Simulation enabling motor." << std::endl;
-                 gpio_put(ENABLE_PIN, 0); // Enable driver
-                 s_currentState = MOTOR_SIMULATING; // Set new state
-                 std::cout << "State: SIMULATING" << std::endl;
-            } else if (s_currentState != MOTOR_SIMULATING) {
-                 // If coming from test run states, force into simulating mode
-                 s_currentState = MOTOR_SIMULATING;
-                 std::cout << "State: SIMULATING (override)" << std::endl;
-            }
-            // Start or update the timer with the new frequency
-            start_step_timer(s_currentPPS);
-        } else { // target_pps_int is 0
-            if (s_currentState != MOTOR_STOPPED) {
-                stop_step_timer();
-                gpio_put(ENABLE_PIN, 1); // Disable driver
-                s_currentState = MOTOR_STOPPED;
-                std::cout << "State: STOPPED (via set_target_frequency(0))" << std::endl;
-            }
-            // If already stopped, do nothing further
-        }
-    }
+float motor_get_peak_tracking_error() {
+    return s_mainAxis.get_peak_tracking_error();
 }
 
+void motor_reset_tracking_stats() {
+    s_mainAxis.reset_tracking_stats();
+}
 
-// --- Module-Internal Helper Function Implementations ---
+void motor_set_edge_capture(bool enabled) {
+    s_mainAxis.set_edge_capture(enabled);
+}
 
-static int64_t pps_to_delay_us(int pps) {                     // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-    if (pps <= 0) {
-        return -1; // Indicate invalid/stop
-    }
-    // Delay is for half a pulse period (timer toggles pin)
-    return (int64_t)(1000000.0 / (2.0 * pps));
+bool motor_is_edge_capture_enabled() {
+    return step_jitter_is_armed();
 }
 
-static bool step_timer_callback(struct repeating_timer *t) {  // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-    s_stepPinState = !s_stepPinState;
-    gpio_put(STEP_PIN, s_stepPinState);
-    return true; // Keep timer running
+void motor_report_edge_jitter() {
+    s_mainAxis.report_edge_jitter();
 }
 
-static void start_step_timer(int pps) {                       // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-    // Stop existing timer if active
-    if (s_timerActive) {
-        cancel_repeating_timer(&s_stepTimer);
-        s_timerActive = false;
+
+// --- Module-Internal Helper Function Implementations ---
+
+static void motor_core_entry() {
+    // Lets flash_safe_execute() on core0 pause this core while flash is written.
+    // The PIO engine keeps stepping at its current rate meanwhile.
+    multicore_lockout_victim_init();
+
+    // Alarms created from this pool fire on core1; each axis uses its own alarm
+    alarm_pool_t* alarm_pool = alarm_pool_create_with_unused_hardware_alarm(MOTOR_ALARM_POOL_SIZE);
+
+    s_mainAxis.core_init(alarm_pool);
+    if (ENABLE_TILT_AXIS) {
+        s_tiltAxis.core_init(alarm_pool);
     }
-    // Calculate new delay
-    int64_t delay_us = pps_to_delay_us(pps);
-    if (delay_us > 0) {
-        // Add the new timer
-        if (add_repeating_timer_us(delay_us, step_timer_callback, NULL, &s_stepTimer)) {
-            s_timerActive = true;
-        } else {
-            std::cout << "Error: Failed to add repeating timer!" << std::endl;
-            // Try to recover safely
-            s_currentState = MOTOR_STOPPED;
-            s_currentPPS = 0;
-            gpio_put(ENABLE_PIN, 1);
-            s_stepPinState = false;
-            gpio_put(STEP_PIN, 0);
+    s_motorCoreReady.store(true, std::memory_order_release);
+
+    while (true) {
+        s_mainAxis.core_poll();
+        if (ENABLE_TILT_AXIS) {
+            s_tiltAxis.core_poll();
         }
-    } else {
-         // If pps <= 0, ensure timer is stopped and pin is low (handled by caller too, but safe)
-         s_stepPinState = false;
-         gpio_put(STEP_PIN, 0);
+        busy_wait_us_32(MOTOR_CORE_POLL_US);
     }
 }
-
-static void stop_step_timer() {                              // From original file [cite: uploaded:my_projects/StepperMotor.cpp]
-    if (s_timerActive) {
-        cancel_repeating_timer(&s_stepTimer);
-        s_timerActive = false;
-    }
-    // Ensure step pin is left in a known low state
-    s_stepPinState = false;
-    gpio_put(STEP_PIN, 0);
-}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define STEPPER_MOTOR_H
 
 #include "pico/stdlib.h"
+#include "motion_planner.h" // For MotionLimits
 
 // --- Public Types ---
 enum MotorState {
@@ -12,17 +13,27 @@ enum MotorState {
     MOTOR_SIMULATING    // New state for direct frequency control
 };
 
+// Consistent step odometry sample. All fields describe the same instant.
+struct MotorOdometry {
+    uint64_t timestamp_us;  // time_us_64() at which the step count was sampled
+    uint64_t steps;         // Position since motor_init(), in microsteps of the finest mode
+    uint64_t revolutions;   // Whole revolutions (steps / steps per revolution)
+    float angle_deg;        // Angle within the current revolution, [0, 360)
+};
+
 // --- Public Function Declarations ---
 
 /**
- * @brief Initializes GPIO pins and internal state for the stepper motor.
- * Call this once during setup.
+ * @brief Starts the motor core (core1), which initializes the motor GPIO pins and
+ * step backend and from then on owns all step generation and motor state.
+ * Call this once during setup, from core0. Returns once core1 is ready.
  */
 void motor_init();
 
 /**
- * @brief Updates the motor's speed and state (handles acceleration/deceleration for test mode).
- * Call this periodically in the main loop. In SIMULATING mode, this function does little.
+ * @brief Reports motor state changes and faults on the console.
+ * The state machine itself runs on core1; this only prints what changed since the
+ * last call, so it never affects motor timing. Call this periodically in the main loop.
  */
 void motor_update_state();
 
@@ -32,28 +43,157 @@ void motor_update_state();
 void motor_start_test();
 
 /**
- * @brief Stops the motor test sequence (initiates deceleration) or stops simulation immediately.
+ * @brief Stops the motor test sequence or simulation (initiates deceleration at the limit).
  */
 void motor_stop_test();
 
 /**
  * @brief Gets the current state of the motor.
+ * Commands are applied asynchronously by core1, so a state change may show up
+ * shortly (within a motor core loop period) after the call that caused it.
  * @return The current MotorState.
  */
 MotorState motor_get_state();
 
 /**
  * @brief Gets the current target/actual speed of the motor in PPS.
- * @return The current PPS value.
+ * @return The current PPS value, rounded to the nearest integer for display.
  */
 int motor_get_current_pps();
 
 /**
- * @brief Sets the target rotational frequency for the motor, bypassing accel/decel.
- * Used for running the simulation profile directly. Puts motor in SIMULATING state.
+ * @brief Gets the distance moved since motor_init(), counted from the STEP pulses output.
+ * @return Microsteps of the finest microstep mode (STEP pulses if the axis never
+ *         switches modes), as last published by the motor core.
+ */
+uint64_t motor_get_step_count();
+
+/**
+ * @brief Gets the driver microstep mode in use. The motor core picks it from the
+ * planned speed (finest mode under the STEP rate limit, with hysteresis); speeds
+ * and steps per revolution are in full steps whatever the mode.
+ * @return Microsteps per full step.
+ */
+uint16_t motor_get_microsteps();
+
+/**
+ * @brief Checks whether the main axis has a working shaft encoder. With one, the
+ * motor core corrects the step rate while simulating and stops the motor on a stall.
+ */
+bool motor_has_encoder();
+
+/**
+ * @brief Gets the speed measured by the encoder (filtered over a few tens of ms).
+ * @return Full steps per second; 0 without an encoder.
+ */
+float motor_get_measured_pps();
+
+/**
+ * @brief Gets the number of stalls the encoder has detected since motor_init().
+ * A stall stops the motor; compare counts to tell it from a normal stop.
+ */
+uint32_t motor_get_stall_count();
+
+/**
+ * @brief Gets a timestamped odometry sample based on the steps actually output.
+ * Lock-free and cheap enough to call at a high rate during a run. The motor core
+ * refreshes the sample every few tens of microseconds.
+ * @return Step count, revolutions and angle, plus the time they were sampled.
+ */
+MotorOdometry motor_get_odometry();
+
+/**
+ * @brief Sets how many full steps make one revolution, for the odometry counters.
+ * @param steps_per_rev Full steps per revolution; 0 is ignored.
+ */
+void motor_set_steps_per_rev(uint32_t steps_per_rev);
+
+/**
+ * @brief Gets the steps per revolution used by the odometry counters.
+ */
+uint32_t motor_get_steps_per_rev();
+
+/**
+ * @brief Average angular velocity between two odometry samples.
+ * @param from Earlier sample.
+ * @param to Later sample.
+ * @return Angular velocity in rad/s, or 0 if no time passed between the samples.
+ */
+float motor_odometry_angular_velocity(const MotorOdometry& from, const MotorOdometry& to);
+
+/**
+ * @brief Sets the target rotational frequency for the motor (simulation profile tracking).
+ * The motor follows the target as fast as the motion limits allow rather than jumping
+ * to it. Puts motor in SIMULATING state; a target of 0 ramps down at the deceleration
+ * limit (DECELERATING) and then stops.
  * @param pps Target frequency in pulses per second (Hz). Negative values are treated as 0.
+ * Fractional rates are passed through unrounded to the step backend.
  */
 void motor_set_target_frequency(float pps);
 
+/**
+ * @brief Gets the current tracking error (commanded target minus planned speed).
+ * @return Error in PPS; positive while the motor is still catching up with a faster target.
+ */
+float motor_get_tracking_error();
+
+/**
+ * @brief Gets the largest absolute tracking error seen since motor_reset_tracking_stats().
+ * @return Peak error in PPS.
+ */
+float motor_get_peak_tracking_error();
+
+/**
+ * @brief Resets the peak tracking error (e.g. at the start of a simulation run).
+ */
+void motor_reset_tracking_stats();
+
+/**
+ * @brief Sets the acceleration/jerk limits used by planned ramps (test run and its stop).
+ * Values <= 0 leave the corresponding limit unchanged.
+ * @param max_accel_pps2 Maximum acceleration in PPS per second.
+ * @param max_decel_pps2 Maximum deceleration in PPS per second.
+ * @param max_jerk_pps3 Maximum jerk in PPS per second squared.
+ */
+void motor_set_motion_limits(float max_accel_pps2, float max_decel_pps2, float max_jerk_pps3);
+
+/**
+ * @brief Gets the motion limits currently used by planned ramps.
+ */
+MotionLimits motor_get_motion_limits();
+
+/**
+ * @brief Sets or clears a resonance band. The motor never holds a speed inside a band:
+ * targets inside it are held at the nearer-side edge, and ramps (test run, stops and
+ * simulation tracking alike) cross it at the full accel/decel limit.
+ * @param index Band slot, 0 to PLANNER_MAX_BANDS - 1.
+ * @param low_pps Lower edge of the band.
+ * @param high_pps Upper edge; <= low_pps clears the slot.
+ * @return False if the index is out of range.
+ */
+bool motor_set_resonance_band(int index, float low_pps, float high_pps);
+
+/**
+ * @brief Prints how long the last run spent inside each configured resonance band.
+ * Also printed automatically when the motor stops.
+ */
+void motor_print_band_report();
+
+/**
+ * @brief Starts (clearing any previous capture) or stops step-edge timestamp capture.
+ * While enabled, every rising STEP edge of the test run or a simulation is timestamped
+ * in the step interrupt and its period error kept for motor_report_edge_jitter().
+ */
+void motor_set_edge_capture(bool enabled);
+
+/**
+ * @brief True while step-edge capture is enabled.
+ */
+bool motor_is_edge_capture_enabled();
+
+/**
+ * @brief Stops capture and prints the period-error histogram with min/max/p99.
+ */
+void motor_report_edge_jitter();
 
 #endif // STEPPER_MOTOR_H
\ No newline at end of file
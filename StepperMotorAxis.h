@@ -0,0 +1,1162 @@
+#ifndef STEPPER_MOTOR_AXIS_H
+#define STEPPER_MOTOR_AXIS_H
+
+/**
+ * @file StepperMotorAxis.h
+ * @brief StepperMotor<Config>: one stepper axis with compile-time pins, polarity and limits.
+ *
+ * Each axis is split between the two cores:
+ *  - core1 (the motor core) calls core_init() once and core_poll() from its loop.
+ *    It owns the axis pins, its step backend (its own PIO state machine or its own
+ *    alarm) and all motor state.
+ *  - core0 (the console) uses the remaining public members, which only push commands
+ *    into the axis queue and read the snapshot the motor core publishes.
+ * State changes and faults are recorded by the motor core as binary events (see
+ * event_log.h); update_state() on the console core formats them later, so console
+ * output can never hold up the control path.
+ *
+ * All speeds and limits are in full steps per second. With several microstep modes
+ * the axis switches mode as the speed changes (see microstep.h): the planner then
+ * plans one call per STEP pulse of the current mode, and the odometry counts in
+ * microsteps of the finest mode, so neither speed nor position jumps at a switch.
+ *
+ * With an encoder fitted (ENCODER_ENABLED), the motor core measures the real speed
+ * every millisecond (see speed_loop.h). In MOTOR_SIMULATING it trims the STEP rate
+ * by a few percent so the measured speed follows the plan; in every moving state a
+ * stall (measured speed far below the plan) cuts the pulses and disables the driver
+ * at once, letting the arm coast down instead of fighting a stalled motor.
+ *
+ * The test run ramp only depends on Config, so it is generated at compile time
+ * (see ramp_table.h) and the step path plays it from the table, handing over to the
+ * planner for the last percent. Changed limits or resonance bands fall back to the
+ * planner, as does any target change mid-ramp.
+ *
+ * Pins and polarity come from Config as constants, so the step path compiles down to
+ * fixed-pin GPIO writes. There can be one instance per Config type: the interrupt
+ * trampolines that cannot carry a context pointer find it through a per-type pointer.
+ *
+ * Config must provide (all static constexpr):
+ *   uint STEP_PIN, DIR_PIN, ENABLE_PIN
+ *   bool STEP_INVERTED        True if the driver steps on a falling edge
+ *   bool ENABLE_ACTIVE_LOW    True if the driver is enabled by a low level
+ *   bool DIR_FORWARD_HIGH     DIR level for the (only) running direction
+ *   bool USE_PIO_STEP_ENGINE  PIO engine, with the alarm as fallback
+ *   float STEP_PULSE_HIGH_US  STEP high time for the PIO engine
+ *   float TEST_TARGET_PPS, START_PPS
+ *   float MAX_ACCEL_PPS2, MAX_DECEL_PPS2, MAX_JERK_PPS3   Default motion limits
+ *   uint32_t STEPS_PER_REV    Default odometry scale (full steps)
+ *   MicrostepMode MICROSTEP_MODES[]  Driver modes, finest first; one entry = no switching
+ *   bool ENCODER_ENABLED      Quadrature encoder on the motor shaft
+ *   bool TEST_RAMP_TABLE      Keep the test run ramp as a table (5 bytes of flash per
+ *                             pulse); false plans it like any other ramp
+ * and, only if MICROSTEP_MODES has more than one entry:
+ *   uint MS1_PIN, MS2_PIN, MS3_PIN   Driver microstep select pins
+ *   float MAX_PULSE_PPS       STEP pulse rate above which a coarser mode is used (PIO engine)
+ *   float MAX_TIMER_PULSE_PPS The same for the alarm backend, which takes two
+ *                             interrupts per pulse (at most MAX_PULSE_PPS)
+ * and, only if ENCODER_ENABLED:
+ *   uint ENCODER_PIN_A        Channel A; channel B on ENCODER_PIN_A + 1
+ *   uint32_t ENCODER_COUNTS_PER_REV  Counts per motor revolution (4 per line)
+ *   bool EDGE_CAPTURE         Feeds step_jitter (at most one axis may)
+ *   const char* LABEL         Prefix for console messages ("" for the main axis)
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+#include "hardware/irq.h"
+#include "StepperMotor.h"   // For MotorState, MotorOdometry
+#include "step_pio.h"
+#include "step_timing.h"
+#include "step_jitter.h"
+#include "motion_planner.h"
+#include "microstep.h"
+#include "ramp_table.h"
+#include "encoder_pio.h"
+#include "speed_loop.h"
+#include "core_sync.h"
+#include "event_log.h"
+#include <iostream> // For console replies (console core only)
+#include <cstdio>   // For printf
+#include <cmath>    // For lroundf, M_PI
+
+// --- Shared Types ---
+
+const size_t MOTOR_COMMAND_QUEUE_SIZE = 16; // Per axis, power of two
+const size_t MOTOR_EVENT_LOG_SIZE = 32;     // Per axis, power of two
+
+// Commands sent from the console core (core0) to the motor core (core1)
+enum MotorCommandType {
+    MOTOR_CMD_START_TEST,
+    MOTOR_CMD_STOP,
+    MOTOR_CMD_SET_TARGET,
+    MOTOR_CMD_SET_LIMITS,
+    MOTOR_CMD_RESET_TRACKING,
+    MOTOR_CMD_SET_EDGE_CAPTURE
+};
+
+struct MotorCommand {
+    MotorCommandType type;
+    float target_pps;     // MOTOR_CMD_SET_TARGET
+    MotionLimits limits;  // MOTOR_CMD_SET_LIMITS
+    bool enabled;         // MOTOR_CMD_SET_EDGE_CAPTURE
+};
+
+// Events the motor core records for update_state; args in LogEvent::args order
+enum MotorEventId : uint16_t {
+    MOTOR_EVT_STATE,        // New state, previous state, planned PPS (rounded)
+    MOTOR_EVT_TIMER_FAULT,  // Step timer could not be started
+    MOTOR_EVT_STALL,        // Measured PPS, planned PPS (rounded)
+    MOTOR_EVT_MICROSTEP     // Microsteps per full step now in use, planned PPS (rounded)
+};
+
+// Everything core0 may read about an axis, published by core1 as one unit
+struct MotorSnapshot {
+    MotorState state;
+    float pps;                  // Planned (commanded) step rate
+    float target_pps;           // Target the planner is tracking (band edge while held)
+    float peak_tracking_error;  // Since the last MOTOR_CMD_RESET_TRACKING
+    uint64_t step_count;        // Position since init, in finest-mode microsteps
+    uint64_t step_time_us;      // When step_count was sampled
+    uint32_t fault_count;       // Step timer start failures since init
+    uint16_t microsteps;        // Microsteps per full step of the driver mode in use
+    float measured_pps;         // Encoder speed (full steps/s), 0 without an encoder
+    uint32_t stall_count;       // Stalls detected since init
+    float band_time_s[PLANNER_MAX_BANDS];       // Time inside each resonance band this run
+    uint32_t band_crossings[PLANNER_MAX_BANDS]; // Entries into each band this run
+};
+
+// The test run ('t') ramp of a Config: START_PPS to TEST_TARGET_PPS at the default limits
+template <typename Config>
+constexpr RampSpec test_ramp_spec() {
+    constexpr size_t mode_count = sizeof(Config::MICROSTEP_MODES) / sizeof(Config::MICROSTEP_MODES[0]);
+    float max_pulse_pps = 0.0f;
+    if constexpr (mode_count > 1) {
+        max_pulse_pps = Config::MAX_PULSE_PPS;
+    }
+    return {Config::START_PPS, Config::TEST_TARGET_PPS, Config::MAX_ACCEL_PPS2, Config::MAX_JERK_PPS3,
+            Config::MICROSTEP_MODES, mode_count, max_pulse_pps};
+}
+
+// --- Axis Template ---
+
+template <typename Config>
+class StepperMotor {
+public:
+    // --- Motor core (core1) ---
+
+    /**
+     * @brief Sets up the axis pins and step backend. Interrupts for the axis run on the calling core.
+     * @param alarm_pool Pool for the alarm backend (one alarm per axis).
+     */
+    void core_init(alarm_pool_t* alarm_pool);
+
+    /**
+     * @brief Applies queued commands, advances the state machine and publishes a snapshot.
+     */
+    void core_poll();
+
+    // --- Console core (core0) ---
+
+    /**
+     * @brief Resets the console-side settings to the Config defaults. Call before core_init().
+     */
+    void console_init();
+
+    /**
+     * @brief Prints state changes and faults since the last call.
+     */
+    void update_state();
+
+    void start_test();
+    void stop();
+    void set_target_frequency(float pps);
+    void set_motion_limits(float max_accel_pps2, float max_decel_pps2, float max_jerk_pps3);
+    bool set_resonance_band(int index, float low_pps, float high_pps);
+    void print_band_report() const;
+    MotionLimits get_motion_limits() const { return limits_; }
+    void reset_tracking_stats() { send_command({MOTOR_CMD_RESET_TRACKING, 0.0f, {}, false}); }
+
+    MotorState get_state() const { return snapshot_.read().state; }
+    float get_current_pps() const { return snapshot_.read().pps; }
+    uint64_t get_step_count() const { return snapshot_.read().step_count; }
+    uint16_t get_microsteps() const { return snapshot_.read().microsteps; }
+    float get_measured_pps() const { return snapshot_.read().measured_pps; }
+    uint32_t get_stall_count() const { return snapshot_.read().stall_count; }
+    float get_tracking_error() const;
+    float get_peak_tracking_error() const { return snapshot_.read().peak_tracking_error; }
+
+    MotorOdometry get_odometry() const;
+    void set_steps_per_rev(uint32_t steps_per_rev) { if (steps_per_rev > 0) steps_per_rev_ = steps_per_rev; }
+    uint32_t get_steps_per_rev() const { return steps_per_rev_; }
+    float odometry_angular_velocity(const MotorOdometry& from, const MotorOdometry& to) const;
+
+    void set_edge_capture(bool enabled);
+    void report_edge_jitter();
+
+    /**
+     * @brief True if the axis got a PIO state machine (valid once core_init() has run).
+     */
+    bool uses_pio() const { return use_pio_steps_; }
+
+    /**
+     * @brief True if the encoder is configured and counting (valid once core_init() has run).
+     */
+    bool has_encoder() const { return use_encoder_; }
+
+private:
+    // --- Console core helpers ---
+    void send_command(const MotorCommand& cmd);
+    void print_event(const LogEvent& event);
+
+    // --- Motor core helpers ---
+    void set_driver_enabled(bool enabled) { gpio_put(Config::ENABLE_PIN, enabled != Config::ENABLE_ACTIVE_LOW); }
+    bool driver_enabled() const { return gpio_get(Config::ENABLE_PIN) != Config::ENABLE_ACTIVE_LOW; }
+    void handle_command(const MotorCommand& cmd);
+    void core_update_state();
+    void set_state(MotorState state);
+    void publish_snapshot();
+    void core_start_test();
+    void core_stop();
+    void core_set_target(float target_pps);
+    void select_start_microstep_mode();
+    void set_microstep_mode(uint8_t mode);
+    void core_finish_microstep_switch();
+    void core_update_speed_loop();
+    bool test_ramp_usable() const;
+    float next_test_ramp_interval();
+    float test_ramp_speed(size_t i) const;
+    void core_sync_test_ramp_speed();
+    void end_test_ramp();
+    void core_stall_stop();
+    void accumulate_step_count();
+    float next_planned_interval();
+    void start_planned_steps();
+    bool step_output_active();
+    uint32_t read_raw_step_count();
+    void start_step_timer(float pps);
+    void stop_step_timer();
+    int64_t on_step_timer();
+
+    // --- Interrupt trampolines ---
+    static float stream_source(void* context) { return static_cast<StepperMotor*>(context)->next_planned_interval(); }
+    static int64_t step_timer_callback(alarm_id_t id, void* user_data) { return static_cast<StepperMotor*>(user_data)->on_step_timer(); }
+    static void step_edge_irq_handler();
+
+    static StepperMotor* s_self; // The instance for this Config (edge IRQ has no context)
+
+    // --- Microstep modes ---
+    static constexpr size_t MICROSTEP_MODE_COUNT = sizeof(Config::MICROSTEP_MODES) / sizeof(Config::MICROSTEP_MODES[0]);
+    static constexpr uint32_t FINEST_MICROSTEPS = Config::MICROSTEP_MODES[0].microsteps;
+    static uint16_t microsteps_of(uint8_t mode) { return Config::MICROSTEP_MODES[mode].microsteps; }
+    static uint32_t pulse_weight(uint8_t mode) { return FINEST_MICROSTEPS / microsteps_of(mode); } // Finest microsteps per pulse
+
+    // --- Encoder speed loop ---
+    static constexpr uint32_t SPEED_LOOP_PERIOD_US = 1000;
+    static constexpr float RATE_SCALE_DEADBAND = 0.0005f; // Smaller changes don't retime the cruise
+
+    // --- Test run ramp (built by the compiler, read from flash) ---
+    static constexpr RampSpec TEST_RAMP_SPEC = test_ramp_spec<Config>();
+    static constexpr size_t TEST_RAMP_LENGTH = Config::TEST_RAMP_TABLE ? ramp_table_length(TEST_RAMP_SPEC) : 0;
+    static_assert(!Config::TEST_RAMP_TABLE || TEST_RAMP_LENGTH > 0, "Test ramp starts at its target");
+    static constexpr RampTable<TEST_RAMP_LENGTH> TEST_RAMP = ramp_table_build<TEST_RAMP_LENGTH>(TEST_RAMP_SPEC);
+
+    // --- Cross-core channels ---
+    SpscQueue<MotorCommand, MOTOR_COMMAND_QUEUE_SIZE> commands_; // core0 -> core1
+    SeqlockSnapshot<MotorSnapshot> snapshot_;                   // core1 -> core0
+    EventLog<MOTOR_EVENT_LOG_SIZE> events_;                     // core1 (and its IRQs) -> core0
+
+    // --- Motor core state (core1 and the step interrupts it owns) ---
+    MotorState state_ = MOTOR_STOPPED;
+    volatile float current_pps_ = 0.0f;         // Commanded rate, kept unrounded
+    volatile bool step_pin_state_ = false;
+    alarm_pool_t* alarm_pool_ = nullptr;
+    alarm_id_t step_alarm_ = 0;                 // Edge alarm for the timer backend
+    volatile uint64_t half_period_q32_ = 0;     // Half-period in effect (Q32.32 us)
+    StepEdgeTime last_edge_ = {0, 0};           // Scheduled time of the last toggle
+    StepEdgeTime next_edge_ = {0, 0};           // Scheduled time of the next toggle
+    volatile bool timer_active_ = false;
+    bool use_pio_steps_ = false;                // True once the PIO engine owns STEP_PIN
+    StepPioChannel pio_ = {};
+    MotionPlanner planner_ = {};                // Per-step ramp planner
+    volatile bool ramp_active_ = false;         // Timer backend: consult planner on each step
+    volatile bool stop_after_pulse_ = false;    // Timer backend: planner finished, end after this pulse
+    bool ramp_hold_pushed_ = false;             // Cruise interval already handed to the backend
+    volatile float peak_tracking_error_ = 0.0f; // Largest |target - planned speed| since reset
+    volatile uint32_t timer_step_count_ = 0;    // Timer backend: pulses completed (wraps)
+    uint32_t last_raw_step_count_ = 0;          // Backend count at the last snapshot
+    uint64_t step_count_ = 0;                   // Extended step count
+    uint32_t fault_count_ = 0;                  // Step timer start failures
+    volatile bool edge_sequence_started_ = false; // Edge capture: previous rising edge belongs to this run
+    uint32_t last_rising_scheduled_us_ = 0;     // Timer backend: scheduled time of the previous rising edge
+    volatile uint8_t microstep_mode_ = 0;       // Mode the MS pins are set to
+    volatile uint8_t microstep_next_ = 0;       // Mode the planner has moved to (differs until switched)
+    float max_pulse_pps_ = 0.0f;                // Coarser modes above this STEP rate (per backend)
+    EncoderPioChannel encoder_ = {};
+    bool use_encoder_ = false;                  // True once the encoder state machine is counting
+    SpeedLoop speed_loop_ = {};
+    uint64_t last_loop_us_ = 0;                 // Time of the last speed loop update
+    volatile float rate_scale_ = 1.0f;          // Speed loop factor on planned intervals
+    uint32_t stall_count_ = 0;                  // Stalls detected
+    volatile size_t test_ramp_index_ = TEST_RAMP_LENGTH; // Next table entry; TEST_RAMP_LENGTH = not on the table
+
+    // --- Console core state (core0 only) ---
+    MotionLimits limits_ = {};                  // Last limits sent to the motor core
+    float last_target_sent_ = -1.0f;            // Last simulation target sent (-1 = none)
+    uint32_t reported_dropped_ = 0;             // Dropped events already reported
+    uint32_t steps_per_rev_ = Config::STEPS_PER_REV; // Odometry scale
+};
+
+template <typename Config>
+StepperMotor<Config>* StepperMotor<Config>::s_self = nullptr;
+
+// --- Motor Core (core1) Implementation ---
+
+template <typename Config>
+void StepperMotor<Config>::core_init(alarm_pool_t* alarm_pool) {
+    s_self = this;
+    alarm_pool_ = alarm_pool;
+
+    // Initialize Stepper GPIO pins
+    gpio_init(Config::DIR_PIN);
+    gpio_init(Config::ENABLE_PIN);
+    gpio_set_dir(Config::DIR_PIN, GPIO_OUT);
+    gpio_set_dir(Config::ENABLE_PIN, GPIO_OUT);
+
+    // Set initial motor hardware state
+    gpio_put(Config::DIR_PIN, Config::DIR_FORWARD_HIGH); // Set default direction
+    set_driver_enabled(false);                           // Start disabled
+
+    if constexpr (MICROSTEP_MODE_COUNT > 1) {
+        gpio_init_mask((1u << Config::MS1_PIN) | (1u << Config::MS2_PIN) | (1u << Config::MS3_PIN));
+        gpio_set_dir_out_masked((1u << Config::MS1_PIN) | (1u << Config::MS2_PIN) | (1u << Config::MS3_PIN));
+    }
+    set_microstep_mode(0); // Finest until a run picks its mode
+
+    if constexpr (Config::ENCODER_ENABLED) {
+        use_encoder_ = encoder_pio_init(&encoder_, Config::ENCODER_PIN_A);
+        speed_loop_init(&speed_loop_, speed_loop_default_params(
+            (float)Config::ENCODER_COUNTS_PER_REV / (float)Config::STEPS_PER_REV, Config::START_PPS));
+    }
+
+    // STEP pin goes to the PIO engine if possible (parked low), otherwise plain GPIO for the alarm
+    use_pio_steps_ = Config::USE_PIO_STEP_ENGINE && step_pio_init(&pio_, Config::STEP_PIN, Config::STEP_PULSE_HIGH_US);
+    if (!use_pio_steps_) {
+        gpio_init(Config::STEP_PIN);
+        gpio_set_dir(Config::STEP_PIN, GPIO_OUT);
+        gpio_put(Config::STEP_PIN, 0); // Ensure step pin is inactive
+    } else if (Config::EDGE_CAPTURE) {
+        // Edge capture for the PIO engine; the pin event itself is only enabled while capturing
+        gpio_add_raw_irq_handler(Config::STEP_PIN, step_edge_irq_handler);
+        irq_set_enabled(IO_IRQ_BANK0, true);
+    }
+    if constexpr (MICROSTEP_MODE_COUNT > 1) {
+        static_assert(Config::MAX_TIMER_PULSE_PPS <= Config::MAX_PULSE_PPS, "The alarm backend can't step faster than PIO");
+        max_pulse_pps_ = use_pio_steps_ ? Config::MAX_PULSE_PPS : Config::MAX_TIMER_PULSE_PPS;
+    }
+    if (Config::STEP_INVERTED) {
+        // After the function select, which resets the override; both backends then drive active-high
+        gpio_set_outover(Config::STEP_PIN, GPIO_OVERRIDE_INVERT);
+    }
+    sleep_ms(10); // Allow driver to settle
+
+    // Initialize internal state variables
+    state_ = MOTOR_STOPPED;
+    current_pps_ = 0.0f;
+    timer_active_ = false;
+    step_pin_state_ = false;
+    planner_init(&planner_, {Config::MAX_ACCEL_PPS2, Config::MAX_DECEL_PPS2, Config::MAX_JERK_PPS3, Config::START_PPS});
+    planner_set_step_distance(&planner_, 1.0f / microsteps_of(microstep_mode_));
+    last_raw_step_count_ = read_raw_step_count();
+    publish_snapshot();
+}
+
+template <typename Config>
+void StepperMotor<Config>::core_poll() {
+    MotorCommand cmd;
+    while (commands_.pop(cmd)) {
+        handle_command(cmd);
+    }
+    if (use_pio_steps_ && microstep_next_ != microstep_mode_) {
+        core_finish_microstep_switch();
+    }
+    core_sync_test_ramp_speed();
+    if (use_encoder_) {
+        core_update_speed_loop();
+    }
+    core_update_state();
+    publish_snapshot();
+}
+
+template <typename Config>
+void StepperMotor<Config>::handle_command(const MotorCommand& cmd) {
+    switch (cmd.type) {
+        case MOTOR_CMD_START_TEST:
+            core_start_test();
+            break;
+        case MOTOR_CMD_STOP:
+            core_stop();
+            break;
+        case MOTOR_CMD_SET_TARGET:
+            core_set_target(cmd.target_pps);
+            break;
+        case MOTOR_CMD_SET_LIMITS: {
+            // The step interrupt reads the limits, so swap them in one piece
+            uint32_t ints = save_and_disable_interrupts();
+            end_test_ramp(); // The table was built for the old limits
+            planner_set_limits(&planner_, cmd.limits);
+            restore_interrupts(ints);
+            break;
+        }
+        case MOTOR_CMD_RESET_TRACKING:
+            peak_tracking_error_ = 0.0f;
+            break;
+        case MOTOR_CMD_SET_EDGE_CAPTURE:
+            if (Config::EDGE_CAPTURE && use_pio_steps_) {
+                // PIO edges never pass through the CPU, so watch the pin (IRQ on this core)
+                gpio_acknowledge_irq(Config::STEP_PIN, GPIO_IRQ_EDGE_RISE);
+                gpio_set_irq_enabled(Config::STEP_PIN, GPIO_IRQ_EDGE_RISE, cmd.enabled);
+            }
+            break;
+    }
+}
+
+// Ramps are planned per step inside the step path, so this only observes the
+// planner and moves the state machine along; its call rate no longer matters.
+template <typename Config>
+void StepperMotor<Config>::core_update_state() {
+    switch (state_) {
+        case MOTOR_ACCELERATING:
+            if (planner_is_settled(&planner_)) {
+                set_state(MOTOR_RUNNING);
+            }
+            break;
+
+        case MOTOR_DECELERATING:
+            // Wait until the planner has issued its last step and the backend has played it
+            if (planner_is_stopped(&planner_) && !step_output_active()) {
+                set_state(MOTOR_STOPPED);
+                stop_step_timer();
+                current_pps_ = 0.0f;
+                set_driver_enabled(false);
+            }
+            break;
+
+        case MOTOR_RUNNING:
+            // State change initiated externally by stop()
+            break;
+
+        case MOTOR_SIMULATING:
+            // Speed tracks set_target_frequency through the planner in the step path.
+            break;
+
+        case MOTOR_STOPPED:
+            // Ensure motor remains disabled and timer stopped
+            if (driver_enabled() || timer_active_) {
+                set_driver_enabled(false);
+                stop_step_timer();
+            }
+            break;
+    }
+}
+
+// Every transition is logged, including ones the console would miss between polls
+template <typename Config>
+void StepperMotor<Config>::set_state(MotorState state) {
+    if (state == state_) {
+        return;
+    }
+    events_.write(time_us_32(), MOTOR_EVT_STATE, state, state_, (int32_t)(current_pps_ + 0.5f));
+    state_ = state;
+}
+
+template <typename Config>
+void StepperMotor<Config>::publish_snapshot() {
+    accumulate_step_count();
+    uint64_t sampled_us = time_us_64();
+
+    MotorSnapshot snap;
+    snap.state = state_;
+    snap.pps = current_pps_;
+    snap.target_pps = planner_held_target(&planner_);
+    snap.peak_tracking_error = peak_tracking_error_;
+    snap.step_count = step_count_;
+    snap.step_time_us = sampled_us;
+    snap.fault_count = fault_count_;
+    snap.microsteps = microsteps_of(microstep_mode_);
+    snap.measured_pps = use_encoder_ ? speed_loop_.measured_pps : 0.0f;
+    snap.stall_count = stall_count_;
+    for (int i = 0; i < PLANNER_MAX_BANDS; ++i) {
+        snap.band_time_s[i] = planner_.band_time_s[i];
+        snap.band_crossings[i] = planner_.band_crossings[i];
+    }
+    snapshot_.write(snap);
+}
+
+template <typename Config>
+void StepperMotor<Config>::core_start_test() {
+    if (state_ != MOTOR_STOPPED) {
+        return; // Raced with another command; core0 already checked
+    }
+    set_state(MOTOR_ACCELERATING);
+    planner_start(&planner_, Config::TEST_TARGET_PPS);
+    select_start_microstep_mode(); // The table starts in the same mode
+    test_ramp_index_ = test_ramp_usable() ? 0 : TEST_RAMP_LENGTH;
+    current_pps_ = planner_.speed;
+    set_driver_enabled(true);
+    start_planned_steps();
+}
+
+template <typename Config>
+void StepperMotor<Config>::core_stop() {
+    if (state_ == MOTOR_SIMULATING) {
+        core_set_target(0.0f); // Ramp down to 0 PPS, then STOPPED
+    } else if (state_ == MOTOR_RUNNING || state_ == MOTOR_ACCELERATING) {
+        // Both ramp down through the planner at the deceleration limit
+        set_state(MOTOR_DECELERATING);
+        planner_set_target(&planner_, 0.0f);
+        start_planned_steps(); // Resume per-step planning if the ramp was cruising
+    }
+}
+
+template <typename Config>
+void StepperMotor<Config>::core_set_target(float target_pps) {
+    if (target_pps == planner_.target && state_ != MOTOR_STOPPED) {
+        return; // Already tracking this target
+    }
+
+    if (target_pps > 0.0f) {
+        if (state_ == MOTOR_STOPPED) {
+            set_driver_enabled(true);
+            set_state(MOTOR_SIMULATING);
+            test_ramp_index_ = TEST_RAMP_LENGTH;
+            planner_start(&planner_, target_pps);
+            select_start_microstep_mode();
+            current_pps_ = planner_.speed;
+        } else {
+            // If coming from test run states (or a ramp-down), force into simulating mode
+            set_state(MOTOR_SIMULATING);
+            planner_set_target(&planner_, target_pps);
+        }
+        // The planner rate-limits the jump to the target within the motion limits
+        start_planned_steps();
+    } else if (state_ != MOTOR_STOPPED) { // target_pps is 0
+        // Ramp down at the deceleration limit; core_update_state finishes the stop
+        planner_set_target(&planner_, 0.0f);
+        start_planned_steps();
+        set_state(MOTOR_DECELERATING);
+    }
+    // If already stopped and target is 0, do nothing further
+}
+
+/*
+ * Step path hook for planned ramps: plans one step and returns its interval.
+ * Runs in the backend's interrupt (PIO FIFO refill or the edge alarm).
+ * Returns > 0 interval (s); 0 = settled, keep repeating; < 0 = planner stopped.
+ */
+template <typename Config>
+float StepperMotor<Config>::next_planned_interval() {
+    bool settled = planner_is_settled(&planner_);
+    if (microstep_next_ != microstep_mode_) {
+        // PIO only (the timer switches on the falling edge, before planning the next step):
+        // park after the last old-mode step instead of repeating it, until the motor core
+        // has switched modes
+        return use_pio_steps_ ? -1.0f : 0.0f;
+    }
+    if (settled && ramp_hold_pushed_) {
+        return 0.0f;
+    }
+    if constexpr (TEST_RAMP_LENGTH > 0) {
+        if (test_ramp_index_ < TEST_RAMP_LENGTH) {
+            if (planner_.target == Config::TEST_TARGET_PPS) {
+                return next_test_ramp_interval() * rate_scale_;
+            }
+            end_test_ramp(); // Stopped or retargeted mid-ramp: the planner carries on from here
+        }
+    }
+    float interval = planner_next_interval(&planner_) * rate_scale_; // step_distance/target once settled, times the loop scale
+    ramp_hold_pushed_ = settled;
+    current_pps_ = planner_.speed;
+
+    if constexpr (MICROSTEP_MODE_COUNT > 1) {
+        // This step was planned (and will be played) in the current mode; the new
+        // mode starts with the next one. The speed carries over, so only the step
+        // interval scales.
+        uint8_t mode = (uint8_t)microstep_select(Config::MICROSTEP_MODES, MICROSTEP_MODE_COUNT, microstep_mode_,
+                                                 planner_.speed, max_pulse_pps_);
+        if (mode != microstep_mode_) {
+            planner_set_step_distance(&planner_, 1.0f / microsteps_of(mode));
+            microstep_next_ = mode;
+        }
+    }
+
+    float error = planner_held_target(&planner_) - planner_.speed; // A target held at a band edge is met there
+    if (error < 0.0f) error = -error;
+    if (error > peak_tracking_error_) peak_tracking_error_ = error;
+    return (interval > 0.0f) ? interval : -1.0f;
+}
+
+// The table holds the steps the planner would plan from START_PPS with the Config
+// limits, so it stands in for it only while those are the limits in force
+template <typename Config>
+bool StepperMotor<Config>::test_ramp_usable() const {
+    if (TEST_RAMP_LENGTH == 0) {
+        return false;
+    }
+    const MotionLimits& lim = planner_.limits;
+    if (lim.max_accel != Config::MAX_ACCEL_PPS2 || lim.max_jerk != Config::MAX_JERK_PPS3 ||
+        lim.start_pps != Config::START_PPS || planner_.speed != Config::START_PPS ||
+        max_pulse_pps_ != test_ramp_spec<Config>().max_pulse_pps) {
+        return false;
+    }
+    for (int i = 0; i < PLANNER_MAX_BANDS; ++i) {
+        if (lim.bands[i].high_pps > lim.bands[i].low_pps) return false;
+    }
+    return true;
+}
+
+// Step path, test run on the table: only indexes it. The planner speed is left to
+// core_sync_test_ramp_speed() on the motor core, and to the hand-overs.
+template <typename Config>
+float StepperMotor<Config>::next_test_ramp_interval() {
+    size_t i = test_ramp_index_;
+    test_ramp_index_ = i + 1;
+    float interval = TEST_RAMP.interval_s[i];
+    if (i + 1 < TEST_RAMP_LENGTH) {
+        uint8_t mode = TEST_RAMP.mode[i + 1];
+        if (mode != microstep_mode_) {
+            planner_set_step_distance(&planner_, 1.0f / microsteps_of(mode));
+            microstep_next_ = mode;
+        }
+    } else {
+        // The table stops short of the target: the planner settles the rest from
+        // the state the generator ended in, so its S-curve carries on unchanged
+        planner_.speed = TEST_RAMP.end_speed;
+        planner_.accel = TEST_RAMP.end_accel;
+        if constexpr (MICROSTEP_MODE_COUNT > 1) {
+            uint8_t mode = (uint8_t)microstep_select(Config::MICROSTEP_MODES, MICROSTEP_MODE_COUNT, microstep_mode_,
+                                                     planner_.speed, max_pulse_pps_);
+            if (mode != microstep_mode_) {
+                planner_set_step_distance(&planner_, 1.0f / microsteps_of(mode));
+                microstep_next_ = mode;
+            }
+        }
+        current_pps_ = planner_.speed;
+    }
+    return interval;
+}
+
+// Mean speed over table entry i (full steps/s)
+template <typename Config>
+float StepperMotor<Config>::test_ramp_speed(size_t i) const {
+    if constexpr (TEST_RAMP_LENGTH > 0) {
+        return 1.0f / (microsteps_of(TEST_RAMP.mode[i]) * TEST_RAMP.interval_s[i]);
+    } else {
+        return 0.0f;
+    }
+}
+
+// Motor core, while the table plays: the planner speed (for the speed loop, the
+// snapshot and the edge capture) from the step last taken off the table
+template <typename Config>
+void StepperMotor<Config>::core_sync_test_ramp_speed() {
+    if constexpr (TEST_RAMP_LENGTH > 0) {
+        uint32_t ints = save_and_disable_interrupts();
+        size_t i = test_ramp_index_;
+        if (i < TEST_RAMP_LENGTH) { // Past the end the planner has the speed again
+            if (i > 0) {
+                planner_.speed = test_ramp_speed(i - 1);
+            }
+            current_pps_ = planner_.speed;
+            float error = planner_.target - planner_.speed;
+            if (error > peak_tracking_error_) peak_tracking_error_ = error;
+        }
+        restore_interrupts(ints);
+    }
+}
+
+// Leaves the table mid-ramp. The speed and acceleration are taken from the last two
+// steps so the planner's S-curve carries on without a jump. Step path or IRQs off.
+template <typename Config>
+void StepperMotor<Config>::end_test_ramp() {
+    size_t i = test_ramp_index_;
+    test_ramp_index_ = TEST_RAMP_LENGTH;
+    if constexpr (TEST_RAMP_LENGTH > 0) {
+        if (i >= TEST_RAMP_LENGTH) {
+            return;
+        }
+        planner_.accel = 0.0f;
+        if (i >= 1) {
+            planner_.speed = test_ramp_speed(i - 1);
+            current_pps_ = planner_.speed;
+        }
+        if (i >= 2) {
+            float t0 = TEST_RAMP.interval_s[i - 2];
+            float t1 = TEST_RAMP.interval_s[i - 1];
+            planner_.accel = (planner_.speed - test_ramp_speed(i - 2)) / (0.5f * (t0 + t1));
+        }
+    }
+}
+
+template <typename Config>
+void StepperMotor<Config>::start_planned_steps() {
+    ramp_hold_pushed_ = false;
+    if (!timer_active_) {
+        edge_sequence_started_ = false; // First edge of a new run has no period
+    }
+    if (use_pio_steps_) {
+        step_pio_stream_start(&pio_, stream_source, this);
+        timer_active_ = true;
+        return;
+    }
+    if (!timer_active_) {
+        start_step_timer(planner_.speed * microsteps_of(microstep_mode_)); // First edge at the pull-in speed
+    }
+    stop_after_pulse_ = false;
+    ramp_active_ = true;
+}
+
+template <typename Config>
+bool StepperMotor<Config>::step_output_active() {
+    return use_pio_steps_ ? step_pio_is_running(&pio_) : timer_active_;
+}
+
+template <typename Config>
+uint32_t StepperMotor<Config>::read_raw_step_count() {
+    return use_pio_steps_ ? step_pio_get_step_count(&pio_) : timer_step_count_;
+}
+
+// The timer ISR counts in finest microsteps itself (it switches modes between
+// pulses); the PIO counter counts pulses, all of the current mode, because the
+// motor core folds the count in before every switch, with the state machine parked.
+template <typename Config>
+void StepperMotor<Config>::accumulate_step_count() {
+    uint32_t raw = read_raw_step_count();
+    uint32_t delta = raw - last_raw_step_count_; // Wrap-safe difference
+    last_raw_step_count_ = raw;
+    step_count_ += use_pio_steps_ ? (uint64_t)delta * pulse_weight(microstep_mode_) : delta;
+}
+
+// Drives the MS pins; the driver uses them from its next STEP edge on
+template <typename Config>
+void StepperMotor<Config>::set_microstep_mode(uint8_t mode) {
+    if constexpr (MICROSTEP_MODE_COUNT > 1) {
+        uint8_t bits = Config::MICROSTEP_MODES[mode].ms_bits;
+        gpio_put_masked((1u << Config::MS1_PIN) | (1u << Config::MS2_PIN) | (1u << Config::MS3_PIN),
+                        ((uint32_t)(bits & 1u) << Config::MS1_PIN) |
+                        ((uint32_t)((bits >> 1) & 1u) << Config::MS2_PIN) |
+                        ((uint32_t)((bits >> 2) & 1u) << Config::MS3_PIN));
+    }
+    if (mode != microstep_mode_) {
+        events_.write(time_us_32(), MOTOR_EVT_MICROSTEP, microsteps_of(mode), (int32_t)(current_pps_ + 0.5f));
+    }
+    microstep_mode_ = mode;
+    microstep_next_ = mode;
+}
+
+// Motor stopped, so nothing is in flight: pick the mode for the start speed directly
+template <typename Config>
+void StepperMotor<Config>::select_start_microstep_mode() {
+    if constexpr (MICROSTEP_MODE_COUNT > 1) {
+        accumulate_step_count();
+        set_microstep_mode((uint8_t)microstep_select(Config::MICROSTEP_MODES, MICROSTEP_MODE_COUNT, 0,
+                                                     planner_.speed, max_pulse_pps_));
+        planner_set_step_distance(&planner_, 1.0f / microsteps_of(microstep_mode_));
+    }
+}
+
+// PIO engine: the stream ended with a stop word after the last step planned in the
+// old mode, so the state machine parks once that step has played instead of
+// repeating it. Parked, every pulse so far ran (and was counted) in the old mode:
+// fold them in, switch and resume the stream, whose first pulse is new-mode.
+// The queue is left to drain between polls; the last period is waited out here, so
+// the resumed stream follows it with only the restart latency.
+template <typename Config>
+void StepperMotor<Config>::core_finish_microstep_switch() {
+    if (!step_pio_is_queue_empty(&pio_)) {
+        return; // Old-mode words still queued; try again next loop
+    }
+    while (step_pio_is_running(&pio_)) {
+        tight_loop_contents(); // At most the last old-mode period
+    }
+    uint32_t ints = save_and_disable_interrupts();
+    accumulate_step_count();
+    set_microstep_mode(microstep_next_);
+    restore_interrupts(ints);
+    start_planned_steps();
+}
+
+// Runs every SPEED_LOOP_PERIOD_US. The planned speed is the feed-forward; the
+// loop's interval scale is handed to the step path, which applies it from the next
+// planned step (a settled cruise is re-planned so the held interval picks it up).
+template <typename Config>
+void StepperMotor<Config>::core_update_speed_loop() {
+    uint64_t now_us = time_us_64();
+    if (state_ == MOTOR_STOPPED) {
+        if (rate_scale_ != 1.0f || speed_loop_.primed) {
+            speed_loop_reset(&speed_loop_);
+            rate_scale_ = 1.0f;
+        }
+        last_loop_us_ = now_us;
+        return;
+    }
+    if (now_us - last_loop_us_ < SPEED_LOOP_PERIOD_US) {
+        return;
+    }
+    float dt_s = (float)(now_us - last_loop_us_) * 1e-6f;
+    last_loop_us_ = now_us;
+
+    float scale = speed_loop_update(&speed_loop_, encoder_pio_get_count(&encoder_), planner_.speed, dt_s,
+                                    state_ == MOTOR_SIMULATING);
+    if (speed_loop_.stalled) {
+        core_stall_stop();
+        return;
+    }
+    float change = scale - rate_scale_;
+    if (change > RATE_SCALE_DEADBAND || change < -RATE_SCALE_DEADBAND) {
+        rate_scale_ = scale;
+        if (planner_is_settled(&planner_)) {
+            start_planned_steps(); // Replace the held cruise interval
+        }
+    }
+}
+
+// Stall: no ramp-down (the rotor is not following the pulses anyway). The pulses
+// stop at once and the driver is released, so the arm coasts down on its own.
+template <typename Config>
+void StepperMotor<Config>::core_stall_stop() {
+    uint32_t ints = save_and_disable_interrupts();
+    test_ramp_index_ = TEST_RAMP_LENGTH;
+    planner_halt(&planner_);
+    stop_step_timer();
+    restore_interrupts(ints);
+    set_driver_enabled(false);
+    events_.write(time_us_32(), MOTOR_EVT_STALL, (int32_t)(speed_loop_.measured_pps + 0.5f),
+                  (int32_t)(current_pps_ + 0.5f));
+    set_state(MOTOR_STOPPED);
+    current_pps_ = 0.0f;
+    stall_count_++;
+    speed_loop_reset(&speed_loop_);
+    rate_scale_ = 1.0f;
+}
+
+// PIO engine edge capture (enabled by MOTOR_CMD_SET_EDGE_CAPTURE). The PIO plays
+// words queued a few steps ahead, so during ramps the planned rate leads slightly.
+template <typename Config>
+void StepperMotor<Config>::step_edge_irq_handler() {
+    uint32_t now_us = time_us_32();
+    if (!(gpio_get_irq_event_mask(Config::STEP_PIN) & GPIO_IRQ_EDGE_RISE)) return;
+    gpio_acknowledge_irq(Config::STEP_PIN, GPIO_IRQ_EDGE_RISE);
+
+    StepperMotor* self = s_self;
+    float pps = self->current_pps_ * microsteps_of(self->microstep_mode_) / self->rate_scale_; // STEP pulse rate
+    uint32_t ideal_ns = (self->edge_sequence_started_ && pps > 0.0f) ? (uint32_t)(1e9f / pps + 0.5f) : 0;
+    step_jitter_record_edge(now_us, ideal_ns);
+    self->edge_sequence_started_ = true;
+}
+
+template <typename Config>
+int64_t StepperMotor<Config>::on_step_timer() {
+    uint32_t fired_us = time_us_32(); // Before anything else, for edge capture
+    step_pin_state_ = !step_pin_state_;
+    gpio_put(Config::STEP_PIN, step_pin_state_);
+    if (!step_pin_state_) {
+        // Falling edge completes a pulse; a mode change planned on its rising edge applies from the next one
+        timer_step_count_ = timer_step_count_ + pulse_weight(microstep_mode_);
+        if (microstep_next_ != microstep_mode_) {
+            set_microstep_mode(microstep_next_);
+        }
+    } else if (Config::EDGE_CAPTURE) {
+        // Compare against the schedule: next_edge_ is this edge's intended time
+        uint32_t scheduled_us = (uint32_t)next_edge_.us;
+        uint32_t ideal_ns = edge_sequence_started_ ? (scheduled_us - last_rising_scheduled_us_) * 1000u : 0;
+        step_jitter_record_edge(fired_us, ideal_ns);
+        last_rising_scheduled_us_ = scheduled_us;
+        edge_sequence_started_ = true;
+    }
+
+    if (!step_pin_state_ && stop_after_pulse_) {
+        // Planned ramp ended: this falling edge completes the last pulse
+        stop_after_pulse_ = false;
+        ramp_active_ = false;
+        timer_active_ = false;
+        return 0;
+    }
+    if (step_pin_state_ && ramp_active_) {
+        // Rising edge: plan the interval to the next step
+        float interval = next_planned_interval();
+        if (interval > 0.0f) {
+            uint64_t half_q32 = (uint64_t)(interval * 500000.0f * (float)STEP_Q32_ONE_US);
+            half_period_q32_ = (half_q32 < STEP_MIN_HALF_PERIOD_Q32) ? STEP_MIN_HALF_PERIOD_Q32 : half_q32;
+        } else if (interval < 0.0f) {
+            stop_after_pulse_ = true;
+        } else {
+            ramp_active_ = false; // Settled: keep repeating the cruise half-period
+        }
+    }
+
+    // Accumulate the exact edge time; the alarm can only fire on its integer part
+    last_edge_ = next_edge_;
+    next_edge_ = step_edge_advance(next_edge_, half_period_q32_);
+    // Negative: relative to this edge's scheduled time, so no drift (always >= 1 us)
+    return -(int64_t)(next_edge_.us - last_edge_.us);
+}
+
+template <typename Config>
+void StepperMotor<Config>::start_step_timer(float pps) {
+    ramp_active_ = false; // Direct frequency control overrides any planned ramp
+    stop_after_pulse_ = false;
+    if (use_pio_steps_) {
+        // The PIO engine retimes at the next period boundary, nothing to cancel
+        step_pio_set_frequency(&pio_, pps);
+        timer_active_ = step_pio_is_running(&pio_);
+        return;
+    }
+
+    // Calculate new half-period (Q32.32 us, the alarm toggles the pin)
+    uint64_t half_q32 = step_half_period_q32(pps);
+    if (half_q32 > 0) {
+        // Retime the running edge sequence instead of restarting it from "now".
+        // IRQs stay off so the alarm cannot toggle between reading and replacing the phase.
+        uint32_t ints = save_and_disable_interrupts();
+        uint64_t now_us = time_us_64();
+        StepEdgeTime next_edge;
+        if (timer_active_) {
+            alarm_pool_cancel_alarm(alarm_pool_, step_alarm_);
+            next_edge = step_retime_next_edge(last_edge_, half_period_q32_, half_q32, now_us);
+        } else {
+            last_edge_ = {now_us, 0};
+            next_edge = step_edge_advance(last_edge_, half_q32);
+        }
+        half_period_q32_ = half_q32;
+        next_edge_ = next_edge;
+        step_alarm_ = alarm_pool_add_alarm_at(alarm_pool_, from_us_since_boot(next_edge.us), step_timer_callback, this, true);
+        timer_active_ = (step_alarm_ > 0);
+        restore_interrupts(ints);
+
+        if (!timer_active_) {
+            fault_count_++;
+            events_.write(time_us_32(), MOTOR_EVT_TIMER_FAULT);
+            // Try to recover safely
+            set_state(MOTOR_STOPPED);
+            current_pps_ = 0.0f;
+            set_driver_enabled(false);
+            step_pin_state_ = false;
+            gpio_put(Config::STEP_PIN, 0);
+        }
+    } else {
+        // If pps <= 0, ensure timer is stopped and pin is low (handled by caller too, but safe)
+        stop_step_timer();
+    }
+}
+
+template <typename Config>
+void StepperMotor<Config>::stop_step_timer() {
+    if (use_pio_steps_) {
+        step_pio_stop(&pio_); // Also leaves the step pin inactive
+        timer_active_ = false;
+        return;
+    }
+    ramp_active_ = false;
+    stop_after_pulse_ = false;
+    if (timer_active_) {
+        alarm_pool_cancel_alarm(alarm_pool_, step_alarm_);
+        timer_active_ = false;
+    }
+    half_period_q32_ = 0;
+    // Ensure step pin is left in a known inactive state
+    step_pin_state_ = false;
+    gpio_put(Config::STEP_PIN, 0);
+}
+
+// --- Console Core (core0) Implementation ---
+
+template <typename Config>
+void StepperMotor<Config>::console_init() {
+    limits_ = {Config::MAX_ACCEL_PPS2, Config::MAX_DECEL_PPS2, Config::MAX_JERK_PPS3, Config::START_PPS};
+    steps_per_rev_ = Config::STEPS_PER_REV;
+    last_target_sent_ = -1.0f;
+    reported_dropped_ = 0;
+}
+
+template <typename Config>
+void StepperMotor<Config>::send_command(const MotorCommand& cmd) {
+    // The motor core drains the queue every loop, so a full queue clears quickly
+    while (!commands_.push(cmd)) {
+        tight_loop_contents();
+    }
+}
+
+// The motor core runs the state machine and logs what it did; this drains the log
+// from the console loop, so console output never delays step generation.
+template <typename Config>
+void StepperMotor<Config>::update_state() {
+    LogEvent event;
+    while (events_.read(event)) {
+        print_event(event);
+    }
+    uint32_t dropped = events_.dropped();
+    if (dropped != reported_dropped_) {
+        printf("%sWarning: %lu motor event(s) dropped\n", Config::LABEL, (unsigned long)(dropped - reported_dropped_));
+        reported_dropped_ = dropped;
+    }
+}
+
+template <typename Config>
+void StepperMotor<Config>::print_event(const LogEvent& event) {
+    printf("[%10.6f] %s", event.time_us * 1e-6, Config::LABEL);
+    switch (event.id) {
+        case MOTOR_EVT_STATE:
+            switch ((MotorState)event.args[0]) {
+                case MOTOR_ACCELERATING:
+                    printf("State: ACCELERATING\n");
+                    break;
+                case MOTOR_RUNNING:
+                    printf("State: RUNNING at %ld PPS\n", (long)event.args[2]);
+                    break;
+                case MOTOR_DECELERATING:
+                    printf("State: DECELERATING\n");
+                    break;
+                case MOTOR_SIMULATING:
+                    printf("State: SIMULATING%s\n",
+                           ((MotorState)event.args[1] == MOTOR_STOPPED) ? " (motor enabled)" : "");
+                    break;
+                case MOTOR_STOPPED:
+                    printf("State: STOPPED\n");
+                    print_band_report();
+                    break;
+            }
+            break;
+        case MOTOR_EVT_TIMER_FAULT:
+            printf("Error: Failed to add repeating timer!\n");
+            break;
+        case MOTOR_EVT_STALL:
+            printf("Error: Stall detected by the encoder (%ld of %ld PPS), motor stopped and released!\n",
+                   (long)event.args[0], (long)event.args[1]);
+            break;
+        case MOTOR_EVT_MICROSTEP:
+            printf("Microstep mode 1/%ld at %ld PPS\n", (long)event.args[0], (long)event.args[1]);
+            break;
+        default:
+            printf("Event %u (%ld, %ld, %ld)\n", event.id, (long)event.args[0], (long)event.args[1],
+                   (long)event.args[2]);
+            break;
+    }
+}
+
+template <typename Config>
+void StepperMotor<Config>::start_test() {
+    if (get_state() == MOTOR_STOPPED) {
+        std::cout << Config::LABEL << "Starting Motor Test..." << std::endl;
+        last_target_sent_ = -1.0f;
+        send_command({MOTOR_CMD_START_TEST, 0.0f, {}, false});
+    } else {
+        std::cout << Config::LABEL << "Motor is not stopped. Use 's' to stop first." << std::endl;
+    }
+}
+
+template <typename Config>
+void StepperMotor<Config>::stop() {
+    MotorState state = get_state();
+    if (state == MOTOR_RUNNING || state == MOTOR_ACCELERATING || state == MOTOR_SIMULATING) {
+        std::cout << Config::LABEL << "Stopping Motor..." << std::endl;
+        last_target_sent_ = -1.0f;
+        send_command({MOTOR_CMD_STOP, 0.0f, {}, false});
+    } else if (state == MOTOR_STOPPED) {
+        std::cout << Config::LABEL << "Motor is already stopped." << std::endl;
+    } else { // Already decelerating
+        std::cout << Config::LABEL << "Motor is already stopping." << std::endl;
+    }
+}
+
+template <typename Config>
+void StepperMotor<Config>::set_target_frequency(float pps) {
+    // No rounding: the step backends resolve fractional rates themselves
+    float target_pps = (pps > 0.0f) ? pps : 0.0f;
+
+    // Profiles repeat targets; don't queue a command the motor core would ignore.
+    // A non-zero target is resent if the motor has stopped since (e.g. after a fault).
+    if (target_pps == last_target_sent_ && (target_pps == 0.0f || get_state() != MOTOR_STOPPED)) {
+        return;
+    }
+    last_target_sent_ = target_pps;
+    send_command({MOTOR_CMD_SET_TARGET, target_pps, {}, false});
+}
+
+template <typename Config>
+void StepperMotor<Config>::set_motion_limits(float max_accel_pps2, float max_decel_pps2, float max_jerk_pps3) {
+    if (max_accel_pps2 > 0.0f) limits_.max_accel = max_accel_pps2;
+    if (max_decel_pps2 > 0.0f) limits_.max_decel = max_decel_pps2;
+    if (max_jerk_pps3 > 0.0f) limits_.max_jerk = max_jerk_pps3;
+    send_command({MOTOR_CMD_SET_LIMITS, 0.0f, limits_, false});
+}
+
+template <typename Config>
+bool StepperMotor<Config>::set_resonance_band(int index, float low_pps, float high_pps) {
+    if (index < 0 || index >= PLANNER_MAX_BANDS) return false;
+    if (high_pps <= low_pps) {
+        low_pps = high_pps = 0.0f; // Clear
+    }
+    limits_.bands[index] = {low_pps, high_pps};
+    send_command({MOTOR_CMD_SET_LIMITS, 0.0f, limits_, false});
+    return true;
+}
+
+// Time spent crossing each configured band during the last run (nothing if no bands)
+template <typename Config>
+void StepperMotor<Config>::print_band_report() const {
+    MotorSnapshot snap = snapshot_.read();
+    for (int i = 0; i < PLANNER_MAX_BANDS; ++i) {
+        const PlannerBand& band = limits_.bands[i];
+        if (band.high_pps <= band.low_pps) continue;
+        printf("%sResonance band %d (%.0f-%.0f PPS): %.3f s inside over %lu crossing(s)\n",
+               Config::LABEL, i + 1, band.low_pps, band.high_pps, snap.band_time_s[i],
+               (unsigned long)snap.band_crossings[i]);
+    }
+}
+
+template <typename Config>
+float StepperMotor<Config>::get_tracking_error() const {
+    MotorSnapshot snap = snapshot_.read();
+    if (snap.state == MOTOR_STOPPED) return 0.0f;
+    return snap.target_pps - snap.pps;
+}
+
+template <typename Config>
+MotorOdometry StepperMotor<Config>::get_odometry() const {
+    MotorSnapshot snap = snapshot_.read();
+    MotorOdometry odo;
+    odo.timestamp_us = snap.step_time_us;
+    odo.steps = snap.step_count;
+    uint64_t microsteps_per_rev = (uint64_t)steps_per_rev_ * FINEST_MICROSTEPS;
+    odo.revolutions = snap.step_count / microsteps_per_rev;
+    uint64_t step_in_rev = snap.step_count - odo.revolutions * microsteps_per_rev;
+    odo.angle_deg = (float)step_in_rev * (360.0f / (float)microsteps_per_rev);
+    return odo;
+}
+
+template <typename Config>
+float StepperMotor<Config>::odometry_angular_velocity(const MotorOdometry& from, const MotorOdometry& to) const {
+    if (to.timestamp_us <= from.timestamp_us) return 0.0f;
+    float steps = (float)(int64_t)(to.steps - from.steps);
+    float seconds = (float)(to.timestamp_us - from.timestamp_us) * 1e-6f;
+    return steps * (2.0f * (float)M_PI / ((float)steps_per_rev_ * FINEST_MICROSTEPS)) / seconds;
+}
+
+template <typename Config>
+void StepperMotor<Config>::set_edge_capture(bool enabled) {
+    if (!Config::EDGE_CAPTURE) return;
+    step_jitter_set_armed(enabled);
+    send_command({MOTOR_CMD_SET_EDGE_CAPTURE, 0.0f, {}, enabled});
+}
+
+template <typename Config>
+void StepperMotor<Config>::report_edge_jitter() {
+    if (!Config::EDGE_CAPTURE) return;
+    send_command({MOTOR_CMD_SET_EDGE_CAPTURE, 0.0f, {}, false});
+    step_jitter_report(use_pio_steps_ ? "PIO engine, STEP pin IRQ vs planned rate"
+                                      : "timer engine, edge alarm vs schedule");
+}
+
+#endif // STEPPER_MOTOR_AXIS_H
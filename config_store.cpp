@@ -0,0 +1,265 @@
+#include "config_store.h"
+#include "pico/flash.h" // For flash_safe_execute (pauses the motor core during writes)
+
+#include <cstring>      // For memcpy, memset
+#include <cstdio>       // For printf
+
+// --- Constants ---
+
+// One log entry. An erased slot is all 0xFF; a slot with a bad CRC (a write cut
+// off by a reset) is skipped and never reused until its sector is erased.
+struct ConfigRecord {
+    uint32_t key;
+    uint32_t sequence;  // Store-wide write counter: the highest is the newest
+    uint32_t value;     // Float bits
+    uint32_t crc;       // CRC-32 of the fields above
+};
+static_assert(sizeof(ConfigRecord) == 16, "Records must tile flash pages");
+
+static const size_t SLOTS_PER_SECTOR = FLASH_SECTOR_SIZE / sizeof(ConfigRecord);
+static const size_t SLOTS_PER_PAGE = FLASH_PAGE_SIZE / sizeof(ConfigRecord);
+static_assert(CONFIG_KEY_COUNT <= SLOTS_PER_SECTOR, "All keys must fit in one sector");
+
+// Upper bound for pausing the motor core before giving up on a write
+static const uint32_t FLASH_SAFE_TIMEOUT_MS = 100;
+
+// --- Module-Internal State Variables ---
+
+struct IndexEntry {
+    uint32_t value;
+    uint32_t sequence;
+    bool present;
+    bool unsaved;       // Newer than flash; written by the next flush
+};
+
+static IndexEntry s_index[CONFIG_KEY_COUNT];
+static uint32_t s_next_sequence = 1;
+static int s_active_sector = CONFIG_STORE_SECTORS - 1;
+static size_t s_next_slot = SLOTS_PER_SECTOR;   // First free slot in the active sector
+static bool s_next_sector_blank = false;        // The sector after the active one is erased
+static bool s_any_unsaved = false;
+
+// --- Module-Internal Helper Functions ---
+
+static uint32_t crc32(const uint8_t* data, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t record_crc(const ConfigRecord* record) {
+    return crc32((const uint8_t*)record, offsetof(ConfigRecord, crc));
+}
+
+static const ConfigRecord* slot_record(int sector, size_t slot) {
+    return (const ConfigRecord*)(CONFIG_STORE_ADDRESS + sector * FLASH_SECTOR_SIZE) + slot;
+}
+
+static bool slot_is_erased(const ConfigRecord* record) {
+    return record->key == 0xFFFFFFFFu && record->sequence == 0xFFFFFFFFu
+        && record->value == 0xFFFFFFFFu && record->crc == 0xFFFFFFFFu;
+}
+
+static bool record_is_valid(const ConfigRecord* record) {
+    return record->key > 0 && record->key < CONFIG_KEY_COUNT && record->crc == record_crc(record);
+}
+
+static bool sector_is_blank(int sector) {
+    for (size_t slot = 0; slot < SLOTS_PER_SECTOR; ++slot) {
+        if (!slot_is_erased(slot_record(sector, slot))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int next_sector(int sector) {
+    return (sector + 1) % CONFIG_STORE_SECTORS;
+}
+
+// Erase/program work handed to flash_safe_execute
+struct StoreFlashJob {
+    uint32_t offset;
+    const uint8_t* page;  // nullptr: erase the sector at offset
+};
+
+static void store_flash_job(void* param) {
+    const StoreFlashJob* job = (const StoreFlashJob*)param;
+    if (job->page) {
+        flash_range_program(job->offset, job->page, FLASH_PAGE_SIZE);
+    } else {
+        flash_range_erase(job->offset, FLASH_SECTOR_SIZE);
+    }
+}
+
+static bool run_flash_job(const StoreFlashJob& job) {
+    return flash_safe_execute(store_flash_job, (void*)&job, FLASH_SAFE_TIMEOUT_MS) == PICO_OK;
+}
+
+// Programs consecutive slots, one page per flash operation. The rest of each page
+// image is 0xFF, which leaves the records already in it untouched.
+static bool program_slots(int sector, size_t first_slot, const ConfigRecord* records, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        size_t slot = first_slot + done;
+        size_t page_first_slot = slot - slot % SLOTS_PER_PAGE;
+        size_t in_page = page_first_slot + SLOTS_PER_PAGE - slot;
+        if (in_page > count - done) in_page = count - done;
+
+        uint8_t page[FLASH_PAGE_SIZE];
+        memset(page, 0xFF, sizeof(page));
+        memcpy(page + (slot - page_first_slot) * sizeof(ConfigRecord), &records[done], in_page * sizeof(ConfigRecord));
+        StoreFlashJob job = {(uint32_t)(CONFIG_STORE_OFFSET + sector * FLASH_SECTOR_SIZE
+                                        + page_first_slot * sizeof(ConfigRecord)), page};
+        if (!run_flash_job(job)) {
+            return false;
+        }
+        done += in_page;
+    }
+    return true;
+}
+
+static ConfigRecord make_record(int key) {
+    ConfigRecord record;
+    record.key = (uint32_t)key;
+    record.sequence = s_next_sequence++;
+    record.value = s_index[key].value;
+    record.crc = record_crc(&record);
+    return record;
+}
+
+// Active sector full: copy every live value into the (erased) next sector and
+// continue the log there. The old sectors keep their copies until erased, so a
+// reset part way through loses nothing.
+static bool rotate_sector() {
+    ConfigRecord records[CONFIG_KEY_COUNT];
+    size_t count = 0;
+    for (int key = 1; key < CONFIG_KEY_COUNT; ++key) {
+        if (s_index[key].present) {
+            records[count++] = make_record(key);
+        }
+    }
+    int sector = next_sector(s_active_sector);
+    if (!program_slots(sector, 0, records, count)) {
+        return false;
+    }
+    s_active_sector = sector;
+    s_next_slot = count;
+    s_next_sector_blank = sector_is_blank(next_sector(sector)); // Usually not: erased by config_store_service()
+    for (int key = 1; key < CONFIG_KEY_COUNT; ++key) {
+        s_index[key].unsaved = false;
+    }
+    s_any_unsaved = false;
+    return true;
+}
+
+// Writes the values held in RAM. False if some must wait for an erase.
+static bool flush_unsaved() {
+    for (int key = 1; key < CONFIG_KEY_COUNT && s_any_unsaved; ++key) {
+        if (!s_index[key].unsaved) {
+            continue;
+        }
+        if (s_next_slot >= SLOTS_PER_SECTOR) {
+            return s_next_sector_blank && rotate_sector(); // Writes all the unsaved keys
+        }
+        ConfigRecord record = make_record(key);
+        size_t slot = s_next_slot++; // A failed write still uses up the slot
+        if (!program_slots(s_active_sector, slot, &record, 1)) {
+            return false;
+        }
+        s_index[key].unsaved = false;
+    }
+    s_any_unsaved = false;
+    return true;
+}
+
+// --- Public Function Implementations ---
+
+int config_store_init() {
+    memset(s_index, 0, sizeof(s_index));
+    uint32_t newest = 0;
+    int newest_sector = -1;
+    for (int sector = 0; sector < CONFIG_STORE_SECTORS; ++sector) {
+        for (size_t slot = 0; slot < SLOTS_PER_SECTOR; ++slot) {
+            const ConfigRecord* record = slot_record(sector, slot);
+            if (!record_is_valid(record)) {
+                continue;
+            }
+            IndexEntry& entry = s_index[record->key];
+            if (!entry.present || record->sequence > entry.sequence) {
+                entry.value = record->value;
+                entry.sequence = record->sequence;
+                entry.present = true;
+            }
+            if (newest_sector < 0 || record->sequence > newest) {
+                newest = record->sequence;
+                newest_sector = sector;
+            }
+        }
+    }
+
+    if (newest_sector < 0) {
+        // Empty store: the first write starts sector 0
+        s_active_sector = CONFIG_STORE_SECTORS - 1;
+        s_next_slot = SLOTS_PER_SECTOR;
+    } else {
+        s_active_sector = newest_sector;
+        s_next_slot = SLOTS_PER_SECTOR;
+        while (s_next_slot > 0 && slot_is_erased(slot_record(s_active_sector, s_next_slot - 1))) {
+            --s_next_slot;
+        }
+    }
+    s_next_sequence = newest + 1;
+    s_next_sector_blank = sector_is_blank(next_sector(s_active_sector));
+    s_any_unsaved = false;
+
+    int found = 0;
+    for (int key = 1; key < CONFIG_KEY_COUNT; ++key) {
+        if (s_index[key].present) ++found;
+    }
+    printf("Config store: %d setting(s), sector %d, %u/%u slots used\n",
+           found, s_active_sector, (unsigned int)s_next_slot, (unsigned int)SLOTS_PER_SECTOR);
+    return found;
+}
+
+bool config_store_get_float(ConfigKey key, float* value) {
+    if (key <= 0 || key >= CONFIG_KEY_COUNT || !s_index[key].present) {
+        return false;
+    }
+    memcpy(value, &s_index[key].value, sizeof(float));
+    return true;
+}
+
+bool config_store_set_float(ConfigKey key, float value) {
+    if (key <= 0 || key >= CONFIG_KEY_COUNT) {
+        return false;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    IndexEntry& entry = s_index[key];
+    if (entry.present && entry.value == bits) {
+        return !entry.unsaved; // Unchanged: no flash wear
+    }
+    entry.value = bits;
+    entry.present = true;
+    entry.unsaved = true;
+    s_any_unsaved = true;
+    return flush_unsaved();
+}
+
+void config_store_service(bool may_erase) {
+    if (!s_next_sector_blank && may_erase) {
+        StoreFlashJob job = {(uint32_t)(CONFIG_STORE_OFFSET + next_sector(s_active_sector) * FLASH_SECTOR_SIZE), nullptr};
+        if (run_flash_job(job)) {
+            s_next_sector_blank = sector_is_blank(next_sector(s_active_sector));
+        }
+    }
+    if (s_any_unsaved) {
+        flush_unsaved();
+    }
+}
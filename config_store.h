@@ -0,0 +1,73 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+/**
+ * @file config_store.h
+ * @brief Persistent settings: a small log-structured key/value store in flash.
+ *
+ * Each change appends one 16-byte CRC-protected record to the active sector;
+ * the newest record of a key wins. The store spans a ring of sectors: when the
+ * active one is full, the live values are copied into the next one and the log
+ * continues there, so erases rotate evenly over the ring. Boot scans the ring once
+ * into a RAM index; reads after that never touch flash.
+ *
+ * Flash access pauses the motor core (flash_safe_execute, as for the profile
+ * store). Appending programs a single page, well under a millisecond. Erasing a
+ * sector takes tens of milliseconds, so it is done ahead of time and only when
+ * config_store_service() is told the motor is idle.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include "hardware/flash.h"     // For FLASH_SECTOR_SIZE
+#include "openrocket_parser.h"  // For FLASH_TARGET_OFFSET (the profile region above the store)
+
+// --- Configuration: Flash Layout ---
+
+// Sectors just below the profile region
+#define CONFIG_STORE_SECTORS   4
+#define CONFIG_STORE_SIZE      (CONFIG_STORE_SECTORS * FLASH_SECTOR_SIZE)
+#define CONFIG_STORE_OFFSET    (FLASH_TARGET_OFFSET - CONFIG_STORE_SIZE)
+#define CONFIG_STORE_ADDRESS   (XIP_BASE + CONFIG_STORE_OFFSET)
+
+// --- Public Types ---
+
+// Stored settings. Append new keys at the end; never renumber or reuse one.
+enum ConfigKey {
+    CONFIG_KEY_SERVO_MIN_PULSE_US = 1,
+    CONFIG_KEY_SERVO_MAX_PULSE_US = 2,
+    CONFIG_KEY_RADIUS_CM = 3,
+    CONFIG_KEY_SERVO_TRAVEL_TIME_S = 4,
+    CONFIG_KEY_COUNT                    // Keys are 1 to CONFIG_KEY_COUNT-1
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Scans the store and builds the RAM index. Call once at boot, before any
+ * module reads its settings.
+ * @return Number of keys found.
+ */
+int config_store_init();
+
+/**
+ * @brief Gets a stored value from the RAM index.
+ * @return False (value untouched) if the key was never stored.
+ */
+bool config_store_get_float(ConfigKey key, float* value);
+
+/**
+ * @brief Stores a value. Writing the value already stored costs nothing.
+ * @return True once it is in flash; false if it is held in RAM until
+ *         config_store_service() can erase a sector for it.
+ */
+bool config_store_set_float(ConfigKey key, float value);
+
+/**
+ * @brief Background upkeep from the main loop: erases the next sector ahead of
+ * time and writes any held values.
+ * @param may_erase True when a sector erase can't disturb anything (motor stopped).
+ */
+void config_store_service(bool may_erase);
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,108 @@
+#ifndef CORE_SYNC_H
+#define CORE_SYNC_H
+
+/**
+ * @file core_sync.h
+ * @brief Lock-free primitives for passing data between core0 and core1.
+ *
+ * Both are single-producer/single-consumer: exactly one core writes and exactly
+ * one core reads each instance. Neither disables interrupts or takes a lock, so
+ * the motor core is never blocked by the console core (or vice versa).
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bounded single-producer/single-consumer ring buffer.
+ * @tparam T Element type (copied in and out).
+ * @tparam N Capacity, must be a power of two.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    /**
+     * @brief Appends an item. Producer side only.
+     * @return False if the queue is full (item not added).
+     */
+    bool push(const T& item) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        buffer_[tail & (N - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item. Consumer side only.
+     * @return False if the queue is empty (out left untouched).
+     */
+    bool pop(T& out) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = buffer_[head & (N - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief True if there is nothing to pop (may be stale by the time it returns).
+     */
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    T buffer_[N];
+    std::atomic<uint32_t> head_{0}; // Next slot to read, written by the consumer
+    std::atomic<uint32_t> tail_{0}; // Next slot to write, written by the producer
+};
+
+/**
+ * @brief Single-writer snapshot published with a sequence counter (seqlock).
+ * The writer never waits; a reader retries if it raced with a write, so it
+ * always gets a consistent copy of the whole struct.
+ * @tparam T Trivially copyable snapshot type.
+ */
+template <typename T>
+class SeqlockSnapshot {
+public:
+    /**
+     * @brief Publishes a new snapshot. Writer side only.
+     */
+    void write(const T& value) {
+        uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed); // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        data_ = value;
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Returns a consistent copy of the latest snapshot. Any core.
+     */
+    T read() const {
+        T copy;
+        uint32_t before, after;
+        do {
+            before = seq_.load(std::memory_order_acquire);
+            copy = data_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq_.load(std::memory_order_relaxed);
+        } while ((before & 1u) || before != after);
+        return copy;
+    }
+
+private:
+    std::atomic<uint32_t> seq_{0};
+    T data_{};
+};
+
+#endif // CORE_SYNC_H
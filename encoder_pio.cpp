@@ -0,0 +1,30 @@
+#include "encoder_pio.h"
+#include "encoder_pio.pio.h"   // Generated by pico_generate_pio_header
+
+#include <cstdio>
+
+// --- Public Function Implementations ---
+
+bool encoder_pio_init(EncoderPioChannel* ch, uint pin_a) {
+    if (!pio_claim_free_sm_and_add_program_for_gpio_range(&quadrature_encoder_program, &ch->pio, &ch->sm, &ch->offset, pin_a, 2, true)) {
+        printf("Error: No free PIO state machine (with offset 0) for the encoder.\n");
+        ch->pio = nullptr;
+        return false;
+    }
+    quadrature_encoder_program_init(ch->pio, ch->sm, ch->offset, pin_a);
+    pio_sm_set_enabled(ch->pio, ch->sm, true);
+
+    printf("Encoder PIO: GPIO %u/%u on pio%u sm%u\n", pin_a, pin_a + 1, pio_get_index(ch->pio), ch->sm);
+    return true;
+}
+
+int32_t encoder_pio_get_count(EncoderPioChannel* ch) {
+    if (!ch->pio) return 0;
+    // The FIFO holds stale counts: drain it, then wait for one pushed after that
+    uint n = pio_sm_get_rx_fifo_level(ch->pio, ch->sm) + 1;
+    uint32_t count = 0;
+    while (n-- > 0) {
+        count = pio_sm_get_blocking(ch->pio, ch->sm);
+    }
+    return (int32_t)count;
+}
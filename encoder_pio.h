@@ -0,0 +1,33 @@
+#ifndef ENCODER_PIO_H
+#define ENCODER_PIO_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+// --- Public Types ---
+
+/**
+ * @brief A quadrature encoder input counted by a PIO state machine (see encoder_pio.pio).
+ */
+struct EncoderPioChannel {
+    PIO pio;   // nullptr until encoder_pio_init() succeeds
+    uint sm;
+    uint offset;
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Claims a state machine (on a PIO block with offset 0 free) and starts counting.
+ * @param pin_a Encoder channel A; channel B must be on pin_a + 1. Both get pull-ups.
+ * @return True on success; false if no suitable PIO block or state machine is free.
+ */
+bool encoder_pio_init(EncoderPioChannel* channel, uint pin_a);
+
+/**
+ * @brief Returns the signed count (4 per encoder line), wrapping at 32 bits.
+ * Takes a few state machine cycles. Call it from one context only.
+ */
+int32_t encoder_pio_get_count(EncoderPioChannel* channel);
+
+#endif // ENCODER_PIO_H
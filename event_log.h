@@ -0,0 +1,111 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+/**
+ * @file event_log.h
+ * @brief Lock-free binary event ring for the motor control path.
+ *
+ * Code on the control path (the motor core loop and the step interrupts that
+ * preempt it) records fixed-size events: an ID, a timestamp and three integer
+ * arguments. Recording is a handful of loads and stores plus one compare-and-swap
+ * and never waits: if the ring is full, the event is dropped and counted. A
+ * low-priority task on the console core drains the ring later and formats the
+ * events, so nothing on the control path touches stdio or USB.
+ *
+ * Any number of writers may share a ring (each slot carries a sequence number,
+ * so a writer interrupted mid-record never exposes a half-written event); there
+ * must be only one reader. Pure C++ with no SDK dependencies: writers pass the
+ * timestamp in.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// --- Public Types ---
+
+struct LogEvent {
+    uint32_t time_us;   // When it happened (microsecond timer, wraps)
+    uint16_t id;        // Meaning of the arguments; defined by the user of the ring
+    int32_t args[3];
+};
+
+/**
+ * @brief Bounded multi-producer/single-consumer event ring.
+ * @tparam N Capacity in events, must be a power of two.
+ */
+template <size_t N>
+class EventLog {
+    static_assert(N > 1 && (N & (N - 1)) == 0, "EventLog capacity must be a power of two");
+
+public:
+    EventLog() {
+        for (size_t i = 0; i < N; ++i) {
+            slots_[i].seq.store((uint32_t)i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Records an event. Any writer, interrupts included; never blocks.
+     * @return False if the ring was full (the event is dropped and counted).
+     */
+    bool write(uint32_t time_us, uint16_t id, int32_t a0 = 0, int32_t a1 = 0, int32_t a2 = 0) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[tail & (N - 1)];
+            int32_t lag = (int32_t)(slot->seq.load(std::memory_order_acquire) - tail);
+            if (lag < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed); // Reader has not freed the slot yet
+                return false;
+            }
+            if (lag == 0 && tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                break; // Slot claimed
+            }
+            if (lag > 0) {
+                tail = tail_.load(std::memory_order_relaxed); // Another writer took it
+            }
+            // Otherwise the failed CAS reloaded tail
+        }
+        slot->event.time_us = time_us;
+        slot->event.id = id;
+        slot->event.args[0] = a0;
+        slot->event.args[1] = a1;
+        slot->event.args[2] = a2;
+        slot->seq.store(tail + 1, std::memory_order_release); // Publish to the reader
+        return true;
+    }
+
+    /**
+     * @brief Takes the oldest complete event. Reader side only.
+     * @return False if there is none (an event still being written counts as none).
+     */
+    bool read(LogEvent& out) {
+        Slot& slot = slots_[head_ & (N - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != head_ + 1) {
+            return false;
+        }
+        out = slot.event;
+        slot.seq.store(head_ + N, std::memory_order_release); // Free for the writer one lap ahead
+        head_++;
+        return true;
+    }
+
+    /**
+     * @brief Events dropped because the ring was full, since construction.
+     */
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq; // == position: free; == position + 1: holds an event
+        LogEvent event;
+    };
+
+    Slot slots_[N];
+    std::atomic<uint32_t> tail_{0};    // Next position to claim, shared by the writers
+    uint32_t head_ = 0;                // Next position to read, reader only
+    std::atomic<uint32_t> dropped_{0};
+};
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,72 @@
+#include "flip_schedule.h"
+#include "openrocket_csv.h"
+#include <cmath>  // For fabsf
+#include <vector>
+
+// --- Module-Internal State Variables ---
+static std::vector<ServoFlip> s_flips;
+
+// --- Module-Internal Helper Functions ---
+
+static int g_sign(float g) {
+    return (g > FLIP_ZERO_BAND_G) ? 1 : ((g < -FLIP_ZERO_BAND_G) ? -1 : 0);
+}
+
+// Where the straight line between two points of opposite sign crosses 0 G
+static float zero_crossing_time(const FlightDataPoint& a, const FlightDataPoint& b) {
+    float span = fabsf(a.acceleration) + fabsf(b.acceleration);
+    return a.timestamp + (b.timestamp - a.timestamp) * (fabsf(a.acceleration) / span);
+}
+
+// --- Public Function Implementations ---
+
+size_t flip_schedule_build() {
+    s_flips.clear();
+    size_t count = get_parsed_data_count();
+    int committed = 0;            // Sign the current servo position stands for
+    float position = 0.0f;
+    bool pending = false;         // Sign changed, waiting out the debounce time
+    float pending_crossing = 0.0f;
+    FlightDataPoint last_signed = {};
+
+    for (size_t i = 0; i < count; ++i) {
+        FlightDataPoint point = get_parsed_data_point(i);
+        int sign = g_sign(point.acceleration);
+        if (sign == 0) {
+            continue; // Near 0 G: no evidence either way
+        }
+        if (committed == 0) {
+            committed = sign; // Position 0.0 stands for the first sign
+        } else if (sign != committed && !pending) {
+            pending = true;
+            pending_crossing = zero_crossing_time(last_signed, point);
+        } else if (sign == committed) {
+            pending = false; // Went back within the debounce time: a glitch
+        }
+
+        if (pending && point.timestamp - pending_crossing >= FLIP_DEBOUNCE_S) {
+            position = (position == 0.0f) ? 1.0f : 0.0f;
+            s_flips.push_back({pending_crossing, position});
+            committed = -committed;
+            pending = false;
+        }
+        last_signed = point;
+    }
+    if (pending) {
+        // The new sign held to the end of the profile
+        position = (position == 0.0f) ? 1.0f : 0.0f;
+        s_flips.push_back({pending_crossing, position});
+    }
+    return s_flips.size();
+}
+
+size_t flip_schedule_count() {
+    return s_flips.size();
+}
+
+ServoFlip flip_schedule_get(size_t index) {
+    if (index >= s_flips.size()) {
+        return {0.0f, 0.0f};
+    }
+    return s_flips[index];
+}
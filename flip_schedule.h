@@ -0,0 +1,50 @@
+#ifndef FLIP_SCHEDULE_H
+#define FLIP_SCHEDULE_H
+
+/**
+ * @file flip_schedule.h
+ * @brief Servo flips for a loaded profile, found ahead of the run.
+ *
+ * The payload servo flips whenever the profile's G changes sign. Built once after
+ * a profile is loaded: the zero crossings of the acceleration are located by
+ * linear interpolation between points, and a sign change only counts once the
+ * new sign has held for FLIP_DEBOUNCE_S of profile time, so noise around 0 G
+ * does not chatter the servo. The flips are stored with the flash profile
+ * (openrocket_parser.h); the run commands each one early by the servo travel
+ * time, so the payload has turned over when the G actually crosses zero.
+ * Pure C++ with no SDK dependencies.
+ */
+
+#include <cstddef>
+
+// --- Public Configuration ---
+const float FLIP_DEBOUNCE_S = 0.05f;        // New sign must hold this long to count
+const float FLIP_ZERO_BAND_G = 0.001f;      // |G| below this has no sign
+
+// --- Public Types ---
+
+struct ServoFlip {
+    float crossing_s;   // Profile time of the zero crossing
+    float position;     // Servo position from then on (0.0 or 1.0)
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Finds the flips in the parsed profile (see openrocket_csv.h). The servo
+ * starts at 0.0, which stands for the sign of the first signed point.
+ * @return Number of flips found.
+ */
+size_t flip_schedule_build();
+
+/**
+ * @brief Number of flips in the last schedule built.
+ */
+size_t flip_schedule_count();
+
+/**
+ * @brief Gets a flip by index (0 to count-1), in time order.
+ */
+ServoFlip flip_schedule_get(size_t index);
+
+#endif // FLIP_SCHEDULE_H
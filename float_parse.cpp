@@ -0,0 +1,146 @@
+#include "float_parse.h"
+
+#include <cstdint>
+#include <cstdlib> // For strtof
+#include <cstring> // For memcpy
+
+// --- Constants ---
+
+// Exact powers of ten: up to 1e10 in float, up to 1e22 in double
+static const float POW10_FLOAT[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+static const double POW10_DOUBLE[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+static const uint64_t MAX_EXACT_FLOAT_MANTISSA = 1ull << 24;
+static const uint64_t MAX_EXACT_DOUBLE_MANTISSA = 1ull << 53;
+static const int MAX_MANTISSA_DIGITS = 19;      // Fits a uint64_t
+static const size_t FALLBACK_BUFFER_SIZE = 64;  // Longest number handed to strtof
+
+// --- Module-Internal Helper Functions ---
+
+static inline bool is_digit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+// The general case: strtof on a terminated copy
+static size_t parse_with_strtof(const char* text, size_t length, size_t skipped, float* value) {
+    char buffer[FALLBACK_BUFFER_SIZE];
+    size_t copy_length = (length < FALLBACK_BUFFER_SIZE - 1) ? length : FALLBACK_BUFFER_SIZE - 1;
+    memcpy(buffer, text, copy_length);
+    buffer[copy_length] = '\0';
+    char* end;
+    float result = strtof(buffer, &end);
+    if (end == buffer) {
+        return 0;
+    }
+    *value = result;
+    return skipped + (size_t)(end - buffer);
+}
+
+// m * 10^e in double is one correctly rounded operation, so the float conversion
+// after it is exact unless the double lands precisely halfway between two floats
+static bool double_step_is_exact(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return (bits & ((1ull << 29) - 1)) != (1ull << 28);
+}
+
+// --- Public Function Implementations ---
+
+size_t parse_float(const char* text, size_t length, float* value) {
+    size_t skipped = 0;
+    while (skipped < length && (text[skipped] == ' ' || text[skipped] == '\t')) ++skipped;
+    const char* p = text + skipped;
+    const char* end = text + length;
+    const char* start = p;
+
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        ++p;
+    }
+    if (p < end && !is_digit(*p) && *p != '.') {
+        return parse_with_strtof(start, (size_t)(end - start), skipped, value); // nan, inf
+    }
+    if (p + 1 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        return parse_with_strtof(start, (size_t)(end - start), skipped, value); // Hex float
+    }
+
+    // Mantissa: significant digits into an integer, the decimal point into the exponent
+    uint64_t mantissa = 0;
+    int digits = 0;            // Significant digits taken (leading zeros are not)
+    int exponent = 0;
+    bool any_digit = false;
+    bool truncated = false;
+    while (p < end && is_digit(*p)) {
+        any_digit = true;
+        if (digits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa != 0) ++digits;
+        } else {
+            ++exponent;
+            truncated = truncated || (*p != '0');
+        }
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && is_digit(*p)) {
+            any_digit = true;
+            if (digits < MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa != 0) ++digits;
+                --exponent;
+            } else {
+                truncated = truncated || (*p != '0');
+            }
+            ++p;
+        }
+    }
+    if (!any_digit) {
+        return 0; // "", ".", "+" ...
+    }
+
+    // Exponent: only taken if digits follow the e and its sign
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool exponent_negative = false;
+        if (q < end && (*q == '+' || *q == '-')) {
+            exponent_negative = (*q == '-');
+            ++q;
+        }
+        if (q < end && is_digit(*q)) {
+            int written = 0;
+            while (q < end && is_digit(*q)) {
+                if (written < 10000) written = written * 10 + (*q - '0');
+                ++q;
+            }
+            exponent += exponent_negative ? -written : written;
+            p = q;
+        }
+    }
+    size_t consumed = skipped + (size_t)(p - start);
+
+    float result;
+    if (mantissa == 0) {
+        result = 0.0f;
+    } else if (!truncated && mantissa <= MAX_EXACT_FLOAT_MANTISSA && exponent >= -10 && exponent <= 10) {
+        // Both operands exact in float: one rounding, the correct one
+        result = (exponent >= 0) ? (float)mantissa * POW10_FLOAT[exponent]
+                                 : (float)mantissa / POW10_FLOAT[-exponent];
+    } else if (!truncated && mantissa <= MAX_EXACT_DOUBLE_MANTISSA && exponent >= -22 && exponent <= 22) {
+        double d = (exponent >= 0) ? (double)mantissa * POW10_DOUBLE[exponent]
+                                   : (double)mantissa / POW10_DOUBLE[-exponent];
+        if (!double_step_is_exact(d)) {
+            return parse_with_strtof(start, (size_t)(end - start), skipped, value);
+        }
+        result = (float)d;
+    } else {
+        return parse_with_strtof(start, (size_t)(end - start), skipped, value);
+    }
+    *value = negative ? -result : result;
+    return consumed;
+}
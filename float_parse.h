@@ -0,0 +1,29 @@
+#ifndef FLOAT_PARSE_H
+#define FLOAT_PARSE_H
+
+/**
+ * @file float_parse.h
+ * @brief Fast text-to-float conversion for the CSV numbers OpenRocket writes.
+ *
+ * Reads [+-]digits[.digits][(e|E)[+-]digits] from a pointer and a length, with no
+ * terminator needed, and reports how much it used. Numbers with up to 7 significant
+ * digits and a small exponent are converted exactly in single precision;
+ * longer ones go through an exact double-precision step. Whatever those can't settle
+ * exactly (more than 19 digits, a far exponent, a halfway case, nan/inf/hex)
+ * falls back to strtof. The result is always the correctly rounded float, the same
+ * as strtof and glibc's sscanf("%f").
+ * Pure C++ with no SDK dependencies.
+ */
+
+#include <cstddef> // For size_t
+
+/**
+ * @brief Parses one number. Leading spaces and tabs are skipped, as sscanf does.
+ * @param text Start of the number; need not be NUL-terminated.
+ * @param length Characters available from text.
+ * @param value Output: the number (untouched if none was found).
+ * @return Characters consumed (leading blanks included), or 0 if there is no number.
+ */
+size_t parse_float(const char* text, size_t length, float* value);
+
+#endif // FLOAT_PARSE_H
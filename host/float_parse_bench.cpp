@@ -0,0 +1,346 @@
+/**
+ * @file float_parse_bench.cpp
+ * @brief Host benchmark and check of parse_float (float_parse.cpp) against sscanf.
+ *
+ * For each export (or a generated 64 KB one when no files are given):
+ *   check   - every data line is read both ways, as sscanf("%f,%f") did before and
+ *             with parse_float; the values must be bit-identical
+ *   speed   - MB/s of the data lines with each, and for the whole parse_openrocket_data
+ * Then a full export (every OpenRocket column, acceleration in m/s²) is parsed
+ * with column selection and checked against a naive reader that converts every
+ * field of every row, and timed against it. Small files check the header handling:
+ * a hand-trimmed 2-column header read by position, and comment lines with commas
+ * around the header. Last, a sweep of random numbers in
+ * the formats exports use (fixed, %g, %E, long mantissas, far exponents) is
+ * compared with strtof bit for bit.
+ * The exit status is non-zero on any mismatch.
+ *
+ * Usage: float_parse_bench [export.csv...]
+ */
+
+#include "float_parse.h"
+#include "openrocket_csv.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>  // For open (quiet parsing)
+#include <random>
+#include <string>
+#include <unistd.h> // For dup/dup2 (quiet parsing)
+#include <vector>
+
+// --- Configuration ---
+
+static const double MIN_BENCH_S = 0.5;      // Repeat each measurement at least this long
+static const int SWEEP_COUNT = 2000000;
+
+// --- Helpers ---
+
+static bool read_file(const char* path, std::string* data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) data->append(buffer, n);
+    fclose(f);
+    return true;
+}
+
+// OpenRocket-style export: comment header, events, time and G in mixed formats
+static std::string generated_export() {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> noise(-0.01f, 0.01f);
+    std::string text = "# Simulation 1\n# Time (s),Vertical acceleration (G)\n# Event IGNITION occurred at t=0 seconds\n";
+    char line[64];
+    for (int i = 0; text.size() < 64 * 1024 - 64; ++i) {
+        double t = i * 0.0123;
+        double g = 5.0 * sin(t * 0.7) * exp(-t / 20.0) + noise(rng);
+        switch (i % 4) {
+            case 0: snprintf(line, sizeof(line), "%.4f,%.4f\n", t, g); break;
+            case 1: snprintf(line, sizeof(line), "%.3f,%.4E\n", t, g); break;
+            case 2: snprintf(line, sizeof(line), "%g,%g\n", t, g); break;
+            default: snprintf(line, sizeof(line), "%.6f,%.7f\n", t, g); break;
+        }
+        text += line;
+    }
+    return text + "# Event APOGEE occurred at t=40 seconds\n";
+}
+
+// Full OpenRocket export: the acceleration column is not next to time, and in m/s²
+static const char* FULL_EXPORT_COLUMNS[] = {
+    "Time (s)", "Altitude (m)", "Vertical velocity (m/s)", "Vertical acceleration (m/s²)",
+    "Total velocity (m/s)", "Total acceleration (m/s²)", "Position East of launch (m)",
+    "Position North of launch (m)", "Lateral distance (m)", "Lateral direction (°)",
+    "Lateral velocity (m/s)", "Lateral acceleration (m/s²)", "Latitude (°)", "Longitude (°)",
+    "Gravitational acceleration (m/s²)", "Angle of attack (°)", "Roll rate (°/s)",
+    "Pitch rate (°/s)", "Yaw rate (°/s)", "Mass (g)", "Thrust (N)", "Drag force (N)",
+    "Drag coefficient ()", "Mach number ()", "Reynolds number ()", "Air temperature (°C)",
+};
+static const int FULL_EXPORT_COLUMN_COUNT = sizeof(FULL_EXPORT_COLUMNS) / sizeof(FULL_EXPORT_COLUMNS[0]);
+static const int FULL_EXPORT_ACCEL_FIELD = 3;
+
+static std::string generated_full_export() {
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> value(-2000.0, 2000.0);
+    std::string text = "# Simulation 1\n#";
+    for (int c = 0; c < FULL_EXPORT_COLUMN_COUNT; ++c) {
+        text += (c == 0) ? " " : ",";
+        text += FULL_EXPORT_COLUMNS[c];
+    }
+    text += "\n# Event IGNITION occurred at t=0 seconds\n";
+    char field[32];
+    for (int i = 0; i < 4000; ++i) {
+        double t = i * 0.01;
+        for (int c = 0; c < FULL_EXPORT_COLUMN_COUNT; ++c) {
+            double v = (c == 0) ? t : (c == FULL_EXPORT_ACCEL_FIELD) ? 49.0 * sin(t * 0.7) : value(rng);
+            snprintf(field, sizeof(field), (c == 0) ? "%.4f" : "%.6g", v);
+            if (c > 0) text += ',';
+            text += field;
+        }
+        text += '\n';
+    }
+    return text + "# Event APOGEE occurred at t=40 seconds\n";
+}
+
+// Data lines as the parser sees them (comments and blank lines dropped)
+static std::vector<std::string> data_lines(const std::string& text) {
+    std::vector<std::string> lines;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find_first_of("\r\n", pos);
+        if (end == std::string::npos) end = text.size();
+        if (end > pos && text[pos] != '#') lines.push_back(text.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    return lines;
+}
+
+static bool parse_pair_sscanf(const std::string& line, float* a, float* b) {
+    return sscanf(line.c_str(), "%f,%f", a, b) == 2;
+}
+
+static bool parse_pair_fast(const std::string& line, float* a, float* b) {
+    size_t used = parse_float(line.data(), line.size(), a);
+    return used > 0 && used < line.size() && line[used] == ','
+        && parse_float(line.data() + used + 1, line.size() - used - 1, b) > 0;
+}
+
+static bool same_bits(float a, float b) {
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// Runs pass() until MIN_BENCH_S has passed; returns MB/s for bytes per pass
+template <typename Pass>
+static double megabytes_per_s(size_t bytes, Pass pass) {
+    using clock = std::chrono::steady_clock;
+    int passes = 0;
+    auto start = clock::now();
+    double elapsed = 0.0;
+    do {
+        pass();
+        ++passes;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < MIN_BENCH_S);
+    return (double)bytes * passes / elapsed / 1e6;
+}
+
+static volatile float s_sink; // Keeps the benchmark loops from being optimised away
+
+// The parser reports as it goes; keep that out of the timings and the results
+static void quiet_stdout(bool quiet) {
+    static int saved_stdout = -1;
+    fflush(stdout);
+    if (quiet && saved_stdout < 0) {
+        saved_stdout = dup(STDOUT_FILENO);
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+    } else if (!quiet && saved_stdout >= 0) {
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(saved_stdout);
+        saved_stdout = -1;
+    }
+}
+
+static bool run_export(const char* name, const std::string& text) {
+    std::vector<std::string> lines = data_lines(text);
+    size_t line_bytes = 0;
+    int mismatches = 0;
+    for (const std::string& line : lines) {
+        line_bytes += line.size() + 1;
+        float a1 = 0, b1 = 0, a2 = 0, b2 = 0;
+        bool ok1 = parse_pair_sscanf(line, &a1, &b1);
+        bool ok2 = parse_pair_fast(line, &a2, &b2);
+        if (ok1 != ok2 || (ok1 && (!same_bits(a1, a2) || !same_bits(b1, b2)))) {
+            if (mismatches++ < 5) printf("  mismatch: '%s'\n", line.c_str());
+        }
+    }
+
+    double sscanf_mbs = megabytes_per_s(line_bytes, [&] {
+        float a, b;
+        for (const std::string& line : lines) { parse_pair_sscanf(line, &a, &b); s_sink = a + b; }
+    });
+    double fast_mbs = megabytes_per_s(line_bytes, [&] {
+        float a, b;
+        for (const std::string& line : lines) { parse_pair_fast(line, &a, &b); s_sink = a + b; }
+    });
+
+    quiet_stdout(true);
+    double whole_mbs = megabytes_per_s(text.size(), [&] { parse_openrocket_data(text.data(), text.size()); });
+    quiet_stdout(false);
+
+    printf("%s: %u lines, %s (%d mismatches)\n", name, (unsigned int)lines.size(),
+           mismatches == 0 ? "identical" : "DIFFERENT", mismatches);
+    printf("  sscanf %.1f MB/s, parse_float %.1f MB/s (%.1fx), parse_openrocket_data %.1f MB/s\n",
+           sscanf_mbs, fast_mbs, fast_mbs / sscanf_mbs, whole_mbs);
+    return mismatches == 0;
+}
+
+// What a reader that converts whole rows does: every field, then pick two
+static bool parse_row_naive(const std::string& line, std::vector<float>* fields) {
+    fields->clear();
+    size_t pos = 0;
+    while (true) {
+        float v;
+        size_t used = parse_float(line.data() + pos, line.size() - pos, &v);
+        if (used == 0) return false;
+        fields->push_back(v);
+        pos += used;
+        if (pos >= line.size()) return true;
+        if (line[pos] != ',') return false;
+        ++pos;
+    }
+}
+
+static bool run_full_export(const std::string& text) {
+    std::vector<std::string> lines = data_lines(text);
+    const float to_g = 1.0f / 9.80665f;
+
+    int mismatches = 0;
+    quiet_stdout(true);
+    bool parsed = parse_openrocket_data(text.data(), text.size());
+    quiet_stdout(false);
+    std::vector<float> fields;
+    size_t count = get_parsed_data_count();
+    if (!parsed || count != lines.size()) {
+        printf("full export: parsed %d, %u points for %u lines\n", parsed, (unsigned int)count, (unsigned int)lines.size());
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        FlightDataPoint point = get_parsed_data_point(i);
+        parse_row_naive(lines[i], &fields);
+        if (!same_bits(point.timestamp, fields[0]) || !same_bits(point.acceleration, fields[FULL_EXPORT_ACCEL_FIELD] * to_g)) {
+            if (mismatches++ < 5) printf("  mismatch: '%s'\n", lines[i].c_str());
+        }
+    }
+
+    double naive_mbs = megabytes_per_s(text.size(), [&] {
+        for (const std::string& line : lines) {
+            if (parse_row_naive(line, &fields)) s_sink = fields[0] + fields[FULL_EXPORT_ACCEL_FIELD];
+        }
+    });
+    quiet_stdout(true);
+    double selected_mbs = megabytes_per_s(text.size(), [&] { parse_openrocket_data(text.data(), text.size()); });
+
+    // A column the file doesn't have must fail the parse
+    set_openrocket_columns("Time", "Vertical acceleration (G)X");
+    bool missing_fails = !parse_openrocket_data(text.data(), text.size());
+    set_openrocket_columns(CSV_DEFAULT_TIME_COLUMN, CSV_DEFAULT_ACCELERATION_COLUMN);
+    quiet_stdout(false);
+
+    printf("full export: %d columns, %u lines, %s (%d mismatches), missing column %s\n",
+           FULL_EXPORT_COLUMN_COUNT, (unsigned int)lines.size(), mismatches == 0 ? "identical" : "DIFFERENT",
+           mismatches, missing_fails ? "rejected" : "NOT REJECTED");
+    printf("  whole rows %.1f MB/s, selected columns %.1f MB/s (%.1fx)\n",
+           naive_mbs, selected_mbs, selected_mbs / naive_mbs);
+    return mismatches == 0 && missing_fails;
+}
+
+// Parses a small file and compares its points with the expected time,G pairs
+static bool header_case(const char* name, const char* text, const float (*expected)[2], size_t expected_count) {
+    quiet_stdout(true);
+    bool parsed = parse_openrocket_data(text, strlen(text));
+    quiet_stdout(false);
+    bool ok = parsed && get_parsed_data_count() == expected_count;
+    for (size_t i = 0; ok && i < expected_count; ++i) {
+        FlightDataPoint point = get_parsed_data_point(i);
+        ok = same_bits(point.timestamp, expected[i][0]) && same_bits(point.acceleration, expected[i][1]);
+    }
+    if (!ok) printf("  %s: parsed %d, %u points\n", name, parsed, (unsigned int)get_parsed_data_count());
+    return ok;
+}
+
+static bool run_headers() {
+    static const float trimmed_points[][2] = {{0.0f, 1.5f}, {0.1f, 2.25f}};
+    static const float metric_points[][2] = {{0.0f, 9.80665f * (1.0f / 9.80665f)}, {0.1f, 19.6133f * (1.0f / 9.80665f)}};
+    static const float commented_points[][2] = {{0.0f, 0.5f}, {0.1f, -0.25f}};
+
+    bool trimmed = header_case("trimmed",
+        "# Time (s),Acceleration (G)\n# Event IGNITION occurred at t=0 seconds\n0,1.5\n0.1,2.25\n", trimmed_points, 2);
+    bool metric = header_case("trimmed m/s²",
+        "# Time (s),Accel (m/s²)\n# Event IGNITION occurred at t=0 seconds\n0,9.80665\n0.1,19.6133\n", metric_points, 2);
+    bool commented = header_case("commented",
+        "# Rocket 'Test', 3 stages, 24 mm motor mount\n"
+        "# Time (s),Altitude (m),Vertical acceleration (G)\n"
+        "# Wind 2 m/s, gusts 4 m/s\n"
+        "# Event IGNITION occurred at t=0 seconds\n0,10,0.5\n0.1,20,-0.25\n", commented_points, 2);
+    bool trimmed_commented = header_case("trimmed commented",
+        "# Time (s),Acceleration (G)\n# Launch rail 1 m, 5 degrees, north\n"
+        "# Event IGNITION occurred at t=0 seconds\n0,1.5\n0.1,2.25\n", trimmed_points, 2);
+
+    printf("headers: 2-column %s, m/s² %s, comments around the header %s / %s\n",
+           trimmed ? "by position" : "REJECTED", metric ? "converted" : "WRONG",
+           commented ? "ignored" : "NOT IGNORED", trimmed_commented ? "ignored" : "NOT IGNORED");
+    return trimmed && metric && commented && trimmed_commented;
+}
+
+// Random numbers in export-like and awkward formats, against strtof
+static bool run_sweep() {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-30, 30);
+    std::uniform_int_distribution<int> digits(1, 9);
+    char text[64];
+    int mismatches = 0;
+    for (int i = 0; i < SWEEP_COUNT; ++i) {
+        double v = (unit(rng) - 0.5) * pow(10.0, exponent(rng));
+        switch (i % 6) {
+            case 0: snprintf(text, sizeof(text), "%.*f", digits(rng) - 1, v * 1e-25); break;
+            case 1: snprintf(text, sizeof(text), "%.*g", digits(rng), v); break;
+            case 2: snprintf(text, sizeof(text), "%.*E", digits(rng), v); break;
+            case 3: snprintf(text, sizeof(text), "%.17g", v); break;   // Long mantissa
+            case 4: snprintf(text, sizeof(text), "%.25e", v); break;   // Past 19 digits
+            default: snprintf(text, sizeof(text), "%.9g", (double)(float)v); break; // Round trip
+        }
+        float expected = strtof(text, nullptr);
+        float parsed = -1.0f;
+        size_t used = parse_float(text, strlen(text), &parsed);
+        if (used != strlen(text) || !same_bits(parsed, expected)) {
+            if (mismatches++ < 5) printf("  mismatch: '%s' -> %a, strtof %a\n", text, parsed, expected);
+        }
+    }
+    printf("sweep: %d numbers, %s (%d mismatches)\n", SWEEP_COUNT, mismatches == 0 ? "identical" : "DIFFERENT", mismatches);
+    return mismatches == 0;
+}
+
+int main(int argc, char** argv) {
+    bool all_ok = true;
+    if (argc < 2) {
+        all_ok = run_export("generated", generated_export()) && all_ok;
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::string text;
+        if (!read_file(argv[i], &text)) {
+            fprintf(stderr, "%s: cannot read\n", argv[i]);
+            all_ok = false;
+            continue;
+        }
+        all_ok = run_export(argv[i], text) && all_ok;
+    }
+    all_ok = run_full_export(generated_full_export()) && all_ok;
+    all_ok = run_headers() && all_ok;
+    all_ok = run_sweep() && all_ok;
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file planner_test.cpp
+ * @brief Host checks of the per-step motion planner (motion_planner.cpp).
+ *
+ * Runs the planner step by step with the main axis limits at 1/16 step:
+ *   stop above - a stop from cruise above the pull-in speed ramps down to
+ *                start_pps and stops there
+ *   stop below - a stop from cruise below the pull-in speed stops at once,
+ *                without first speeding up to start_pps
+ *   stop slowing - a stop while still decelerating below the pull-in speed winds
+ *                the deceleration out and stops; the speed never rises
+ *   band hold  - a target inside a resonance band settles at the band edge on the
+ *                side the motor comes from (planner_is_settled, planner_held_target)
+ * Prints one line per check; the exit status is non-zero if any fails.
+ */
+
+#include "motion_planner.h"
+#include "rig_defaults.h"
+
+#include <cstdio>
+
+// --- Configuration ---
+
+static const float STEP_DISTANCE = 1.0f / 16.0f;
+static const int MAX_STEPS = 1000000; // Bound on any one ramp
+
+// --- Helpers ---
+
+static bool report(const char* name, bool pass, const char* detail) {
+    printf("%-12s %s  %s\n", name, pass ? "PASS" : "FAIL", detail);
+    return pass;
+}
+
+static void start_planner(MotionPlanner* planner, float target_pps) {
+    planner_init(planner, MAIN_AXIS_DRIVE.limits);
+    planner_set_step_distance(planner, STEP_DISTANCE);
+    planner_start(planner, target_pps);
+}
+
+// Plans steps until the planner settles; false if it never does
+static bool run_until_settled(MotionPlanner* planner) {
+    for (int i = 0; i < MAX_STEPS; ++i) {
+        if (planner_is_settled(planner)) return true;
+        planner_next_interval(planner);
+    }
+    return false;
+}
+
+// Stops the planner and follows the ramp down
+struct StopResult {
+    bool stopped;
+    int steps;
+    float highest_pps;    // Highest speed planned after the stop
+    float last_pps;       // Speed of the last step before stopping
+    bool rose;            // Speed went up from one step to the next
+};
+
+static StopResult run_stop(MotionPlanner* planner) {
+    StopResult result = {false, 0, planner->speed, planner->speed, false};
+    planner_set_target(planner, 0.0f);
+    float previous = planner->speed;
+    while (result.steps < MAX_STEPS) {
+        float speed = planner->speed;
+        planner_next_interval(planner);
+        ++result.steps;
+        if (planner_is_stopped(planner)) {
+            result.stopped = true;
+            result.last_pps = speed;
+            break;
+        }
+        if (planner->speed > result.highest_pps) result.highest_pps = planner->speed;
+        if (planner->speed > previous) result.rose = true;
+        previous = planner->speed;
+    }
+    return result;
+}
+
+// --- Checks ---
+
+static bool check_stop_above() {
+    const float start_pps = MAIN_AXIS_DRIVE.limits.start_pps;
+    MotionPlanner planner;
+    start_planner(&planner, 1200.0f);
+    bool ok = run_until_settled(&planner);
+    StopResult stop = run_stop(&planner);
+    ok = ok && stop.stopped && !stop.rose && stop.last_pps == start_pps;
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "1200 PPS -> 0 in %d steps, last step at %.1f PPS", stop.steps, stop.last_pps);
+    return report("stop above", ok, detail);
+}
+
+static bool check_stop_below() {
+    const float cruise_pps = 0.5f * MAIN_AXIS_DRIVE.limits.start_pps;
+    MotionPlanner planner;
+    start_planner(&planner, cruise_pps);
+    bool ok = run_until_settled(&planner);
+    for (int i = 0; i < 100; ++i) planner_next_interval(&planner);
+    StopResult stop = run_stop(&planner);
+    ok = ok && stop.stopped && !stop.rose && stop.highest_pps <= cruise_pps && stop.steps == 1;
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%.0f PPS -> 0 in %d steps, highest %.1f PPS", cruise_pps, stop.steps, stop.highest_pps);
+    return report("stop below", ok, detail);
+}
+
+static bool check_stop_slowing() {
+    const float start_pps = MAIN_AXIS_DRIVE.limits.start_pps;
+    MotionPlanner planner;
+    start_planner(&planner, 600.0f);
+    bool ok = run_until_settled(&planner);
+
+    // Slow towards a target under the pull-in speed and stop on the way
+    planner_set_target(&planner, 0.3f * start_pps);
+    int steps = 0;
+    while (planner.speed >= 0.8f * start_pps && steps++ < MAX_STEPS) {
+        planner_next_interval(&planner);
+    }
+    float accel_at_stop = planner.accel;
+    float speed_at_stop = planner.speed;
+    StopResult stop = run_stop(&planner);
+    ok = ok && accel_at_stop < 0.0f && stop.stopped && !stop.rose && stop.highest_pps <= speed_at_stop;
+
+    char detail[128];
+    snprintf(detail, sizeof(detail), "%.1f PPS at %.0f PPS/s -> 0 in %d steps, last step at %.1f PPS",
+             speed_at_stop, accel_at_stop, stop.steps, stop.last_pps);
+    return report("stop slowing", ok, detail);
+}
+
+static bool check_band_hold() {
+    const PlannerBand band = {400.0f, 500.0f};
+    MotionLimits limits = MAIN_AXIS_DRIVE.limits;
+    limits.bands[0] = band;
+    bool ok = true;
+    float settled_at[2] = {0.0f, 0.0f};
+
+    // From below (a 't'-style start) and from above (slowing into the band)
+    const float approach_pps[2] = {0.0f, 700.0f};
+    const float expected_pps[2] = {band.low_pps, band.high_pps};
+    for (int side = 0; side < 2; ++side) {
+        MotionPlanner planner;
+        planner_init(&planner, limits);
+        planner_set_step_distance(&planner, STEP_DISTANCE);
+        if (approach_pps[side] > 0.0f) {
+            planner_start(&planner, approach_pps[side]);
+            ok = ok && run_until_settled(&planner);
+            planner_set_target(&planner, 450.0f);
+        } else {
+            planner_start(&planner, 450.0f);
+        }
+        bool settled = run_until_settled(&planner);
+        settled_at[side] = planner.speed;
+        ok = ok && settled && planner.speed == expected_pps[side] && planner_held_target(&planner) == expected_pps[side];
+
+        // Settled means every further step repeats the same interval
+        float interval = planner_next_interval(&planner);
+        ok = ok && planner_is_settled(&planner) && interval == STEP_DISTANCE / expected_pps[side];
+    }
+
+    char detail[128];
+    snprintf(detail, sizeof(detail), "target 450 in a %.0f-%.0f band settles at %.1f from below, %.1f from above",
+             band.low_pps, band.high_pps, settled_at[0], settled_at[1]);
+    return report("band hold", ok, detail);
+}
+
+// --- Entry Point ---
+
+int main() {
+    bool ok = true;
+    ok &= check_stop_above();
+    ok &= check_stop_below();
+    ok &= check_stop_slowing();
+    ok &= check_band_hold();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+/**
+ * @file profile_sim.cpp
+ * @brief Offline check of OpenRocket exports against the stepper/arm model (Linux).
+ *
+ * Loads each CSV exactly like the firmware ('l': parse_openrocket_data and
+ * calculate_pps_for_parsed_data), replays the motor_set_target_frequency sequence
+ * of menu_run_simulation ('r') through the stepper_dynamics model and prints one
+ * line per file with the predicted lost steps and G error. Runs far faster than
+ * real time, so whole directories of exports can be swept before a run.
+ *
+ * Usage: profile_sim [options] export.csv...
+ *   --radius-cm R      Arm radius (default 15, as in the config menu)
+ *   --load-inertia J   Arm + payload inertia at the shaft, kg m^2
+ *   --holding-torque T Motor holding torque, N m
+ *   --corner-pps F     Full-step rate where torque is down to 1/sqrt(2)
+ *   --drag K           Aerodynamic drag, N m s^2
+ *   --friction T       Coulomb friction, N m
+ *   --dt-us D          Integration step
+ *   -v                 Show the parser output
+ */
+
+#include "stepper_dynamics.h"
+#include "rig_defaults.h"
+#include "openrocket_csv.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h> // For dup/dup2 (quiet loading)
+#include <fcntl.h>
+
+static const double DEFAULT_DT_US = 10.0;
+static const double STOP_TIMEOUT_S = 30.0; // Ramp-down time allowed after the last point
+static const float STANDARD_GRAVITY = 9.80665f;
+
+// --- Helpers ---
+
+struct ProfileResult {
+    size_t points;
+    double duration_s;
+    float peak_pps;
+    float max_lag_steps;
+    int64_t lost_steps;
+    float max_g_error;
+    float rms_g_error;
+    double max_g_error_time_s;
+};
+
+static bool read_file(const char* path, std::vector<char>* data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        data->insert(data->end(), chunk, chunk + n);
+    }
+    fclose(f);
+    return true;
+}
+
+// Same steps as menu_load_simulation_from_sd_to_flash, minus SD and flash
+static bool load_profile(const char* path, float radius_m, bool verbose) {
+    std::vector<char> data;
+    if (!read_file(path, &data) || data.empty()) {
+        fprintf(stderr, "%s: cannot read\n", path);
+        return false;
+    }
+    fflush(stdout);
+    int saved_stdout = -1;
+    if (!verbose) {
+        saved_stdout = dup(STDOUT_FILENO);
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+    }
+    bool ok = parse_openrocket_data(data.data(), data.size()) && get_parsed_data_count() > 0 &&
+              calculate_pps_for_parsed_data(radius_m);
+    fflush(stdout);
+    if (saved_stdout >= 0) {
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(saved_stdout);
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: no usable flight data\n", path);
+    }
+    return ok;
+}
+
+// Replays menu_run_simulation: at each point's time, set the target, then read
+// the achieved G from the rotor travel since the previous point (as the firmware
+// does from the step odometry)
+static ProfileResult run_profile(const StepperDynamicsParams& motor, double dt_s, float radius_m) {
+    StepperSim sim;
+    stepper_sim_init(&sim, motor, MAIN_AXIS_DRIVE, dt_s);
+
+    ProfileResult result = {};
+    result.points = get_parsed_data_count();
+    double sum_sq = 0.0;
+    double previous_time = 0.0;
+    double previous_angle = 0.0;
+
+    for (size_t i = 0; i < result.points; ++i) {
+        FlightDataPoint point = get_parsed_data_point(i);
+        if (point.timestamp > sim.time_s) {
+            stepper_sim_advance_to(&sim, point.timestamp);
+        }
+        stepper_sim_set_target(&sim, point.target_pps);
+        if (point.target_pps > result.peak_pps) result.peak_pps = point.target_pps;
+
+        double elapsed = sim.time_s - previous_time;
+        if (elapsed > 0.0) {
+            float omega = (float)((sim.angle - previous_angle) / elapsed);
+            float achieved_g = omega * omega * radius_m / STANDARD_GRAVITY;
+            float error = achieved_g - fabsf(point.acceleration);
+            sum_sq += (double)error * error;
+            if (fabsf(error) > result.max_g_error) {
+                result.max_g_error = fabsf(error);
+                result.max_g_error_time_s = sim.time_s;
+            }
+        }
+        previous_time = sim.time_s;
+        previous_angle = sim.angle;
+    }
+
+    // End of the run: target 0, then let the ramp-down finish
+    stepper_sim_set_target(&sim, 0.0f);
+    double stop_deadline = sim.time_s + STOP_TIMEOUT_S;
+    while (sim.running && sim.time_s < stop_deadline) {
+        stepper_sim_advance_to(&sim, sim.time_s + 0.1);
+    }
+    stepper_sim_advance_to(&sim, sim.time_s + 0.5); // Let the arm settle
+
+    result.duration_s = sim.time_s;
+    result.max_lag_steps = sim.max_lag_steps;
+    result.lost_steps = stepper_sim_lost_steps(&sim);
+    result.rms_g_error = (result.points > 0) ? (float)sqrt(sum_sq / result.points) : 0.0f;
+    return result;
+}
+
+static bool parse_option(const char* name, int argc, char** argv, int* i, double* value) {
+    if (strcmp(argv[*i], name) != 0) return false;
+    if (*i + 1 >= argc) {
+        fprintf(stderr, "%s needs a value\n", name);
+        exit(2);
+    }
+    *value = atof(argv[++*i]);
+    return true;
+}
+
+// --- Entry Point ---
+
+int main(int argc, char** argv) {
+    StepperDynamicsParams motor = DEFAULT_MOTOR;
+    double radius_cm = 15.0;
+    double dt_us = DEFAULT_DT_US;
+    bool verbose = false;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; ++i) {
+        double v;
+        if (parse_option("--radius-cm", argc, argv, &i, &radius_cm)) continue;
+        if (parse_option("--dt-us", argc, argv, &i, &dt_us)) continue;
+        if (parse_option("--load-inertia", argc, argv, &i, &v)) { motor.load_inertia_kgm2 = (float)v; continue; }
+        if (parse_option("--holding-torque", argc, argv, &i, &v)) { motor.holding_torque_nm = (float)v; continue; }
+        if (parse_option("--corner-pps", argc, argv, &i, &v)) { motor.corner_pps = (float)v; continue; }
+        if (parse_option("--drag", argc, argv, &i, &v)) { motor.drag_nms2 = (float)v; continue; }
+        if (parse_option("--friction", argc, argv, &i, &v)) { motor.friction_nm = (float)v; continue; }
+        if (strcmp(argv[i], "-v") == 0) { verbose = true; continue; }
+        if (argv[i][0] == '-') {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+        files.push_back(argv[i]);
+    }
+    if (files.empty() || radius_cm <= 0.0 || dt_us <= 0.0) {
+        fprintf(stderr, "Usage: %s [--radius-cm R] [--load-inertia J] [--holding-torque T] [--corner-pps F]\n"
+                        "          [--drag K] [--friction T] [--dt-us D] [-v] export.csv...\n", argv[0]);
+        return 2;
+    }
+
+    float radius_m = (float)(radius_cm / 100.0);
+    int failing = 0;
+    printf("file, points, sim time (s), peak PPS, max lag (steps), lost steps, max |G err|, at (s), RMS G err, result\n");
+    for (const char* path : files) {
+        if (!load_profile(path, radius_m, verbose)) {
+            failing++;
+            continue;
+        }
+        ProfileResult r = run_profile(motor, dt_us * 1e-6, radius_m);
+        bool lost = r.lost_steps != 0;
+        if (lost) failing++;
+        printf("%s, %u, %.2f, %.0f, %.2f, %lld, %.3f, %.3f, %.3f, %s\n",
+               path, (unsigned int)r.points, r.duration_s, r.peak_pps, r.max_lag_steps,
+               (long long)r.lost_steps, r.max_g_error, r.max_g_error_time_s, r.rms_g_error,
+               lost ? "LOST STEPS" : "ok");
+    }
+    return failing ? 1 : 0;
+}
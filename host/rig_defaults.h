@@ -0,0 +1,32 @@
+#ifndef RIG_DEFAULTS_H
+#define RIG_DEFAULTS_H
+
+/**
+ * @file rig_defaults.h
+ * @brief Main axis drive settings and default motor/arm constants for the host tools.
+ * The drive settings mirror MainAxisConfig in StepperMotor.cpp; keep them in step.
+ */
+
+#include "stepper_dynamics.h"
+
+static const MicrostepMode MAIN_AXIS_MODES[] = {
+    {16, 0b111}, {8, 0b011}, {4, 0b010}, {2, 0b001}, {1, 0b000}
+};
+static const StepperDriveConfig MAIN_AXIS_DRIVE = {
+    {1000.0f, 2500.0f, 5000.0f, 100.0f, {}},
+    MAIN_AXIS_MODES, sizeof(MAIN_AXIS_MODES) / sizeof(MAIN_AXIS_MODES[0]), 20000.0f
+};
+
+// A NEMA 17 (0.45 N m) on a light arm; measure the rig and pass the real values
+static const StepperDynamicsParams DEFAULT_MOTOR = {
+    0.45f,    // holding_torque_nm
+    800.0f,   // corner_pps
+    6.8e-6f,  // rotor_inertia_kgm2
+    1.5e-3f,  // load_inertia_kgm2
+    0.01f,    // friction_nm
+    2e-4f,    // viscous_nms
+    2e-5f,    // drag_nms2
+    200       // steps_per_rev (RPM = PPS * 0.3)
+};
+
+#endif // RIG_DEFAULTS_H
@@ -0,0 +1,185 @@
+/**
+ * @file servo_latency_sim.cpp
+ * @brief Host check of the servo latency test (servo_feedback.cpp) against a
+ * simulated servo and feedback pot.
+ *
+ * Models the firmware's command path: the frame interrupt steps servo_motion and
+ * writes the level, which the PWM latches at the following wrap. The simulated
+ * servo reads each pulse and, after its processing delay, drives towards it at
+ * a limited speed. Its pot is sampled with noise at the ADC rate into the same
+ * ring and moving average as the firmware. The latency test polls that, and its
+ * results are compared with the same test fed the exact (noise-free) servo position:
+ *   analog  - 50 Hz frames, slow servo
+ *   digital - 333 Hz frames, fast servo with a processing delay
+ * Both directions are run for each. Prints one line per run; the exit status is
+ * non-zero if any differs by more than the tolerance.
+ */
+
+#include "servo_feedback.h"
+#include "servo_motion.h"
+
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <random>
+
+// --- Configuration ---
+
+static const double DT_S = 10e-6;
+static const float MIN_PULSE_US = 600.0f;
+static const float MAX_PULSE_US = 2400.0f;
+static const float POT_RAW_AT_MIN = 400.0f;     // Pot reading at each end of travel
+static const float POT_RAW_AT_MAX = 3600.0f;
+static const float POT_NOISE_COUNTS = 6.0f;     // RMS, servo PWM pickup included
+static const float TOLERANCE_S = 0.003f;        // Moving-average delay plus poll period, with margin
+
+// --- Helpers ---
+
+struct ServoModel {
+    const char* name;
+    float frame_rate_hz;
+    float processing_s;   // Pulse end to the servo acting on it
+    float max_speed;      // Travel per second
+    float gain;           // Per second: speed per unit of position error below max_speed
+};
+
+struct LatencyRig {
+    ServoModel model;
+    std::mt19937 rng;
+    std::normal_distribution<float> noise;
+    ServoMotion motion;           // Firmware motion engine (unlimited, as by default)
+    double time_s;
+    double next_wrap_s;
+    float latched_position;       // Position whose pulse the PWM outputs this frame
+    float written_position;       // Written by the frame interrupt, latched at the next wrap
+    std::deque<std::pair<double, float>> servo_pending; // Pulses read, each acted on at its time
+    float servo_command;
+    float servo_position;         // True shaft position
+    uint16_t ring[SERVO_FEEDBACK_AVERAGE];
+    size_t ring_index;
+    double next_sample_s;
+};
+
+static void rig_init(LatencyRig* rig, const ServoModel& model, float position) {
+    rig->model = model;
+    rig->rng.seed(12345);
+    rig->noise = std::normal_distribution<float>(0.0f, POT_NOISE_COUNTS);
+    servo_motion_init(&rig->motion, {0.0f, 0.0f}, position);
+    rig->time_s = 0.0;
+    rig->next_wrap_s = 1.0 / model.frame_rate_hz;
+    rig->latched_position = rig->written_position = position;
+    rig->servo_pending.clear();
+    rig->servo_command = rig->servo_position = position;
+    for (size_t i = 0; i < SERVO_FEEDBACK_AVERAGE; ++i) {
+        rig->ring[i] = (uint16_t)(POT_RAW_AT_MIN + (POT_RAW_AT_MAX - POT_RAW_AT_MIN) * position);
+    }
+    rig->ring_index = 0;
+    rig->next_sample_s = 0.0;
+}
+
+static uint64_t rig_time_us(const LatencyRig* rig) {
+    return (uint64_t)llround(rig->time_s * 1e6);
+}
+
+static void rig_step(LatencyRig* rig) {
+    const ServoModel& m = rig->model;
+    rig->time_s += DT_S;
+
+    if (rig->time_s >= rig->next_wrap_s) {
+        // Wrap: the level written last frame goes out; the interrupt writes the next one
+        rig->latched_position = rig->written_position;
+        servo_motion_step(&rig->motion, 1.0f / m.frame_rate_hz);
+        rig->written_position = rig->motion.position;
+        float pulse_s = (MIN_PULSE_US + (MAX_PULSE_US - MIN_PULSE_US) * rig->latched_position) * 1e-6f;
+        rig->servo_pending.push_back({rig->next_wrap_s + pulse_s + m.processing_s, rig->latched_position});
+        rig->next_wrap_s += 1.0 / m.frame_rate_hz;
+    }
+    while (!rig->servo_pending.empty() && rig->time_s >= rig->servo_pending.front().first) {
+        rig->servo_command = rig->servo_pending.front().second;
+        rig->servo_pending.pop_front();
+    }
+
+    float speed = m.gain * (rig->servo_command - rig->servo_position);
+    if (speed > m.max_speed) speed = m.max_speed;
+    if (speed < -m.max_speed) speed = -m.max_speed;
+    rig->servo_position += speed * (float)DT_S;
+
+    if (rig->time_s >= rig->next_sample_s) {
+        float raw = POT_RAW_AT_MIN + (POT_RAW_AT_MAX - POT_RAW_AT_MIN) * rig->servo_position + rig->noise(rig->rng);
+        raw = fminf(fmaxf(roundf(raw), 0.0f), 4095.0f);
+        rig->ring[rig->ring_index] = (uint16_t)raw;
+        rig->ring_index = (rig->ring_index + 1) % SERVO_FEEDBACK_AVERAGE;
+        rig->next_sample_s += 1.0 / SERVO_FEEDBACK_SAMPLE_HZ;
+    }
+}
+
+static void rig_run_for(LatencyRig* rig, double seconds) {
+    double end_s = rig->time_s + seconds;
+    while (rig->time_s < end_s) {
+        rig_step(rig);
+    }
+}
+
+static float rig_feedback_raw(const LatencyRig* rig) {
+    return servo_feedback_average(rig->ring, SERVO_FEEDBACK_AVERAGE);
+}
+
+// Same sequence as servo_calibrate_feedback() and servo_measure_latency()
+static bool run_direction(const ServoModel& model, float from, float to) {
+    LatencyRig rig;
+    rig_init(&rig, model, 0.0f);
+    ServoFeedbackCal cal;
+    rig_run_for(&rig, 1.0);
+    cal.raw_at_min = rig_feedback_raw(&rig);
+    servo_motion_set_target(&rig.motion, 1.0f);
+    rig_run_for(&rig, 1.0);
+    cal.raw_at_max = rig_feedback_raw(&rig);
+    if (!servo_feedback_cal_valid(cal)) {
+        printf("%-8s %.0f->%.0f FAIL  calibration span too small\n", model.name, from, to);
+        return false;
+    }
+
+    servo_motion_set_target(&rig.motion, from);
+    rig_run_for(&rig, 1.0);
+
+    ServoLatencyTest measured, truth;
+    servo_latency_start(&measured, from, to, rig_time_us(&rig));
+    servo_latency_start(&truth, from, to, rig_time_us(&rig));
+    servo_motion_set_target(&rig.motion, to);
+    bool measured_done = false, truth_done = false;
+    double next_poll_s = rig.time_s;
+    while (!measured_done || !truth_done) {
+        rig_step(&rig);
+        if (!truth_done) {
+            truth_done = servo_latency_update(&truth, rig_time_us(&rig), rig.servo_position);
+        }
+        if (!measured_done && rig.time_s >= next_poll_s) {
+            float position = servo_feedback_position(cal, rig_feedback_raw(&rig));
+            measured_done = servo_latency_update(&measured, rig_time_us(&rig), position);
+            next_poll_s += SERVO_LATENCY_POLL_US * 1e-6;
+        }
+    }
+
+    float start_s = servo_latency_start_s(&measured), true_start_s = servo_latency_start_s(&truth);
+    float settle_s = servo_latency_settle_s(&measured), true_settle_s = servo_latency_settle_s(&truth);
+    bool pass = measured.settled && truth.settled
+             && fabsf(start_s - true_start_s) <= TOLERANCE_S
+             && fabsf(settle_s - true_settle_s) <= TOLERANCE_S;
+    printf("%-8s %.0f->%.0f %s  start %.1f ms (true %.1f), settle %.1f ms (true %.1f)\n",
+           model.name, from, to, pass ? "PASS" : "FAIL",
+           start_s * 1e3f, true_start_s * 1e3f, settle_s * 1e3f, true_settle_s * 1e3f);
+    return pass;
+}
+
+int main() {
+    const ServoModel models[] = {
+        {"analog", 50.0f, 0.0005f, 1.0f / 0.24f, 60.0f},   // 0.12 s/60 deg over 120 deg
+        {"digital", 333.0f, 0.002f, 1.0f / 0.16f, 120.0f}, // 0.08 s/60 deg
+    };
+    bool all_pass = true;
+    for (const ServoModel& model : models) {
+        all_pass = run_direction(model, 0.0f, 1.0f) && all_pass;
+        all_pass = run_direction(model, 1.0f, 0.0f) && all_pass;
+    }
+    return all_pass ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file speed_loop_sim.cpp
+ * @brief Host check of the encoder speed loop (speed_loop.cpp) against a simulated encoder.
+ *
+ * Runs the firmware speed loop at its 1 ms period on the stepper_dynamics model,
+ * with the encoder count derived from the simulated arm angle, and checks:
+ *   steady  - no slip: the loop stays near zero correction and never trips
+ *   slip    - the arm runs 2% slow (slipping coupling): the loop trims the STEP
+ *             rate up until the measured speed matches the planned one
+ *   stall   - a brake torque stalls the motor at speed: a stall is reported
+ *             within stall_time_s plus the filter lag and the steps are cut
+ * Prints one line per scenario; the exit status is non-zero if any fails.
+ */
+
+#include "stepper_dynamics.h"
+#include "rig_defaults.h"
+#include "speed_loop.h"
+
+#include <cmath>
+#include <cstdio>
+
+// --- Configuration (mirrors the main axis encoder settings) ---
+
+static const float ENCODER_COUNTS_PER_REV = 2400.0f; // 600-line encoder, 4x decoding
+static const double LOOP_PERIOD_S = 0.001;
+static const double DT_S = 10e-6;
+static const float TARGET_PPS = 1200.0f;
+
+// --- Helpers ---
+
+struct ScenarioResult {
+    float final_error;     // (planned - measured) / planned over the last second
+    float final_scale;     // Interval scale applied at the end
+    bool stalled;
+    double stall_time_s;   // When the stall was reported
+};
+
+static int32_t simulated_encoder(const StepperSim* sim, float coupling_ratio) {
+    double arm_angle = sim->angle * coupling_ratio;
+    return (int32_t)(int64_t)floor(arm_angle * ENCODER_COUNTS_PER_REV / (2.0 * M_PI));
+}
+
+// Ramps to TARGET_PPS (closed loop, as in MOTOR_SIMULATING) and runs for duration_s.
+// brake_at_s < 0: no brake.
+static ScenarioResult run_scenario(float coupling_ratio, double duration_s, double brake_at_s, float brake_nm) {
+    StepperSim sim;
+    stepper_sim_init(&sim, DEFAULT_MOTOR, MAIN_AXIS_DRIVE, DT_S);
+    SpeedLoop loop;
+    speed_loop_init(&loop, speed_loop_default_params(ENCODER_COUNTS_PER_REV / DEFAULT_MOTOR.steps_per_rev,
+                                                     MAIN_AXIS_DRIVE.limits.start_pps));
+
+    ScenarioResult result = {0.0f, 1.0f, false, 0.0};
+    stepper_sim_set_target(&sim, TARGET_PPS);
+    double window_start_s = duration_s - 1.0;
+    int32_t window_count = 0;
+    double window_planned_steps = 0.0;
+    while (sim.time_s < duration_s) {
+        if (sim.time_s >= window_start_s) {
+            if (window_planned_steps == 0.0) window_count = simulated_encoder(&sim, coupling_ratio);
+            window_planned_steps += sim.planner.speed * LOOP_PERIOD_S;
+        }
+        if (brake_at_s >= 0.0 && sim.time_s >= brake_at_s) {
+            sim.brake_torque_nm = brake_nm;
+        }
+        stepper_sim_advance_to(&sim, sim.time_s + LOOP_PERIOD_S);
+
+        float scale = speed_loop_update(&loop, simulated_encoder(&sim, coupling_ratio), sim.planner.speed,
+                                        (float)LOOP_PERIOD_S, true);
+        if (loop.stalled) {
+            // What the motor core does: cut the steps at once
+            planner_halt(&sim.planner);
+            sim.running = false;
+            result.stalled = true;
+            result.stall_time_s = sim.time_s;
+            break;
+        }
+        sim.rate_scale = scale;
+        result.final_scale = scale;
+    }
+    if (!result.stalled && window_planned_steps > 0.0) {
+        double measured_steps = (simulated_encoder(&sim, coupling_ratio) - window_count) / ENCODER_COUNTS_PER_REV *
+                                DEFAULT_MOTOR.steps_per_rev;
+        result.final_error = (float)((window_planned_steps - measured_steps) / window_planned_steps);
+    }
+    return result;
+}
+
+static bool report(const char* name, bool pass, const ScenarioResult& r) {
+    printf("%-6s %s  error %+.3f%%, interval scale %.4f, %s\n", name, pass ? "PASS" : "FAIL",
+           r.final_error * 100.0f, r.final_scale,
+           r.stalled ? "stalled" : "no stall");
+    if (r.stalled) printf("       stall reported at t = %.3f s\n", r.stall_time_s);
+    return pass;
+}
+
+// --- Entry Point ---
+
+int main() {
+    bool ok = true;
+
+    ScenarioResult steady = run_scenario(1.0f, 4.0, -1.0, 0.0f);
+    ok &= report("steady", !steady.stalled && fabsf(steady.final_error) < 0.005f && fabsf(steady.final_scale - 1.0f) < 0.005f, steady);
+
+    ScenarioResult slip = run_scenario(0.98f, 4.0, -1.0, 0.0f);
+    ok &= report("slip", !slip.stalled && fabsf(slip.final_error) < 0.005f && slip.final_scale < 0.985f, slip);
+
+    const double brake_at = 2.5;
+    ScenarioResult stall = run_scenario(1.0f, 4.0, brake_at, 0.5f);
+    ok &= report("stall", stall.stalled && stall.stall_time_s > brake_at && stall.stall_time_s < brake_at + 0.25, stall);
+
+    return ok ? 0 : 1;
+}
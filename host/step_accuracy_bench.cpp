@@ -0,0 +1,73 @@
+/**
+ * @file step_accuracy_bench.cpp
+ * @brief Host benchmark of the timer backend's average step rate (step_timing.h).
+ *
+ * For each rate, the edges of a long run are generated the way the alarm
+ * callback does (Q32.32 accumulation, each alarm firing on the whole
+ * microsecond of its edge) and the steps completed are compared with the
+ * ideal count, rate x time. Both ways the half-period is set are run:
+ *   direct - step_half_period_q32(pps), used by motor_set_target_frequency
+ *   ramp   - the float interval the planner hands to the alarm callback
+ * The whole-microsecond truncation used before is shown for comparison.
+ * The exit status is non-zero if any error exceeds MAX_ERROR_PPM.
+ */
+
+#include "step_timing.h"
+
+#include <cmath>
+#include <cstdio>
+
+// --- Configuration ---
+
+static const double RUN_S = 600.0;
+static const double MAX_ERROR_PPM = 100.0;  // 0.01%
+
+// --- Helpers ---
+
+// Steps completed (rising edges fired) within RUN_S at a fixed half-period
+static uint64_t steps_in_run(uint64_t half_q32) {
+    const uint64_t start_us = 1000000;
+    const uint64_t end_us = start_us + (uint64_t)(RUN_S * 1e6);
+    StepEdgeTime edge = {start_us, 0};
+    uint64_t edges = 0;
+    while (true) {
+        edge = step_edge_advance(edge, half_q32);
+        if (edge.us > end_us) break; // The alarm for this edge fires on edge.us
+        ++edges;
+    }
+    return (edges + 1) / 2; // The pin starts low: odd edges are rising
+}
+
+// Half-period from the planner's float interval, as in step_timer_callback
+static uint64_t ramp_half_q32(float pps) {
+    float interval = 1.0f / pps;
+    uint64_t half_q32 = (uint64_t)(interval * 500000.0f * (float)STEP_Q32_ONE_US);
+    return (half_q32 < STEP_MIN_HALF_PERIOD_Q32) ? STEP_MIN_HALF_PERIOD_Q32 : half_q32;
+}
+
+static double error_ppm(uint64_t steps, double ideal) {
+    return ((double)steps - ideal) / ideal * 1e6;
+}
+
+// --- Entry Point ---
+
+int main() {
+    const float rates[] = {37.5f, 333.3f, 1200.0f, 1201.0f, 4999.0f, 7777.7f, 12345.6f, 19999.0f, 20000.0f};
+    bool ok = true;
+    double worst_ppm = 0.0;
+    printf("%.0f s runs, bound %.0f ppm\n", RUN_S, MAX_ERROR_PPM);
+    printf("    PPS   ideal steps   direct (ppm)   ramp (ppm)   whole-us (ppm)\n");
+    for (float pps : rates) {
+        double ideal = (double)pps * RUN_S;
+        double direct = error_ppm(steps_in_run(step_half_period_q32(pps)), ideal);
+        double ramp = error_ppm(steps_in_run(ramp_half_q32(pps)), ideal);
+        uint64_t whole_us = (uint64_t)(500000.0f / pps) * STEP_Q32_ONE_US;
+        double truncated = error_ppm(steps_in_run(whole_us), ideal);
+        bool pass = fabs(direct) <= MAX_ERROR_PPM && fabs(ramp) <= MAX_ERROR_PPM;
+        ok &= pass;
+        worst_ppm = fmax(worst_ppm, fmax(fabs(direct), fabs(ramp)));
+        printf("%8.1f %12.0f %+14.3f %+12.3f %+16.1f  %s\n", pps, ideal, direct, ramp, truncated, pass ? "PASS" : "FAIL");
+    }
+    printf("worst error %.3f ppm (%.5f%%) %s\n", worst_ppm, worst_ppm / 1e4, ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file step_timing_test.cpp
+ * @brief Host checks of the step timing arithmetic (step_timing.h).
+ *
+ * PIO period words:
+ *   round trip - every period the program can produce encodes to a word that
+ *                decodes back to exactly that period
+ *   clamp      - periods at or below the program overhead give the minimum word (1)
+ *   pps        - rates encode to the nearest cycle; rates below ~0.03 PPS saturate
+ *                to the longest period; pps <= 0 (and NaN) encode a stop (0)
+ * Timer backend edge schedule (Q32.32 us), driven through random speed changes
+ * at random points of the half-period in flight, as start_step_timer does:
+ *   retime     - the edge after a change carries the elapsed fraction of the old
+ *                half-period into the new one; it is never before "now" nor on
+ *                the previous edge (no doubled edge), never sooner than one new
+ *                half-period on a speed-up (no runt) and never sooner than the old
+ *                half-period on a slow-down; every later edge is exactly one new
+ *                half-period after the one before
+ *   late       - a change arriving after the edge was due fires it at once
+ * Prints one line per check; the exit status is non-zero if any fails.
+ */
+
+#include "step_timing.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// --- Configuration (mirrors step_pio.cpp at the default clock) ---
+
+static const uint32_t SM_CLOCK_HZ = 150000000;       // clk_sys, divider 1
+static const uint32_t PULSE_HIGH_CYCLES = 3 * 150;   // 3 us STEP high time
+static const int RETIME_CHANGES = 200000;
+static const int EDGES_BETWEEN_CHANGES = 7;
+static const int64_t CARRY_TOLERANCE_Q32 = 4096;     // ~1 ns of double rounding
+
+// --- Helpers ---
+
+static bool report(const char* name, bool pass, const char* detail) {
+    printf("%-10s %s  %s\n", name, pass ? "PASS" : "FAIL", detail);
+    return pass;
+}
+
+// --- PIO Period Words ---
+
+static bool check_round_trip(uint32_t high_count) {
+    const uint64_t fixed = (uint64_t)high_count + STEP_PIO_HIGH_OVERHEAD_CYCLES + STEP_PIO_LOW_OVERHEAD_CYCLES;
+    int failures = 0;
+    uint64_t checked = 0;
+    // Every period just above the minimum, then a stride up to the largest
+    for (uint64_t period = fixed + 1; period <= UINT32_MAX; period += (period < fixed + 100000) ? 1 : 65537) {
+        uint32_t word = step_pio_encode_period((uint32_t)period, high_count);
+        if (word == 0 || step_pio_decode_period(word, high_count) != period) {
+            if (failures++ < 5) printf("  period %llu -> word %lu\n", (unsigned long long)period, (unsigned long)word);
+        }
+        ++checked;
+    }
+    uint32_t top = step_pio_encode_period(UINT32_MAX, high_count);
+    if (step_pio_decode_period(top, high_count) != UINT32_MAX) failures++;
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%llu periods from %llu cycles, %d wrong",
+             (unsigned long long)checked, (unsigned long long)fixed + 1, failures);
+    return report("round trip", failures == 0, detail);
+}
+
+static bool check_clamp(uint32_t high_count) {
+    const uint32_t fixed = high_count + STEP_PIO_HIGH_OVERHEAD_CYCLES + STEP_PIO_LOW_OVERHEAD_CYCLES;
+    bool ok = true;
+    for (uint32_t period = 0; period <= fixed; ++period) {
+        ok = ok && step_pio_encode_period(period, high_count) == 1;
+    }
+    ok = ok && step_pio_encode_period(fixed + 1, high_count) == 1; // Exactly the minimum
+    ok = ok && step_pio_encode_period(fixed + 2, high_count) == 2;
+    ok = ok && step_pio_high_count(0) == 0 && step_pio_high_count(STEP_PIO_HIGH_OVERHEAD_CYCLES) == 0
+            && step_pio_high_count(PULSE_HIGH_CYCLES) == PULSE_HIGH_CYCLES - STEP_PIO_HIGH_OVERHEAD_CYCLES;
+    ok = ok && step_pio_decode_period(1, 0) == STEP_PIO_MIN_PERIOD_CYCLES;
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "periods 0-%lu give word 1 (%lu cycles)",
+             (unsigned long)fixed, (unsigned long)(fixed + 1));
+    return report("clamp", ok, detail);
+}
+
+static bool check_pps(uint32_t high_count) {
+    const float rates[] = {20000.0f, 19999.0f, 1200.0f, 333.3f, 37.5f, 1.0f, 0.05f};
+    bool ok = true;
+    double worst_cycles = 0.0;
+    for (float pps : rates) {
+        uint32_t word = step_pio_encode_pps(pps, SM_CLOCK_HZ, high_count);
+        double ideal = (double)SM_CLOCK_HZ / (double)pps;
+        double error = fabs((double)step_pio_decode_period(word, high_count) - ideal);
+        // Nearest cycle, within the float the period is computed in
+        double allowed = 0.5 + ideal * 0x1p-23;
+        ok = ok && word != 0 && error <= allowed;
+        if (error > worst_cycles) worst_cycles = error;
+    }
+
+    // Below ~0.035 PPS the period no longer fits 32 bits: the longest period, not a wrap
+    const uint32_t longest = step_pio_encode_period(UINT32_MAX, high_count);
+    bool saturates = step_pio_encode_pps(0.03f, SM_CLOCK_HZ, high_count) == longest
+                  && step_pio_encode_pps(1e-6f, SM_CLOCK_HZ, high_count) == longest
+                  && step_pio_encode_pps(1e-30f, SM_CLOCK_HZ, high_count) == longest;
+
+    bool stops = step_pio_encode_pps(0.0f, SM_CLOCK_HZ, high_count) == 0
+              && step_pio_encode_pps(-0.0f, SM_CLOCK_HZ, high_count) == 0
+              && step_pio_encode_pps(-1200.0f, SM_CLOCK_HZ, high_count) == 0
+              && step_pio_encode_pps(NAN, SM_CLOCK_HZ, high_count) == 0;
+
+    char detail[128];
+    snprintf(detail, sizeof(detail), "worst %.2f cycles from ideal, sub-1 PPS %s, pps <= 0 %s",
+             worst_cycles, saturates ? "saturates" : "WRAPS", stops ? "stops" : "DOES NOT STOP");
+    return report("pps", ok && saturates && stops, detail);
+}
+
+// --- Timer Backend Edge Schedule ---
+
+// b - a in Q32.32 microseconds (edges are close together, so this can't overflow)
+static int64_t edge_diff_q32(StepEdgeTime b, StepEdgeTime a) {
+    return (int64_t)(b.us - a.us) * (int64_t)STEP_Q32_ONE_US + ((int64_t)b.frac - (int64_t)a.frac);
+}
+
+static bool check_retime() {
+    const float rates[] = {10.0f, 37.5f, 333.3f, 1200.0f, 1201.0f, 4999.0f, 12345.6f, 20000.0f};
+    const int rate_count = sizeof(rates) / sizeof(rates[0]);
+    std::mt19937_64 rng(11);
+    std::uniform_int_distribution<int> pick_rate(0, rate_count - 1);
+
+    StepEdgeTime last = {1000000, 0x12345678u};
+    uint64_t half = step_half_period_q32(rates[3]);
+    StepEdgeTime next = step_edge_advance(last, half);
+    int failures = 0;
+    int64_t worst_carry_q32 = 0;
+    double shortest_speedup = 1e9;  // Transition gap / new half-period
+    double shortest_slowdown = 1e9; // Transition gap / old half-period
+
+    for (int change = 0; change < RETIME_CHANGES; ++change) {
+        // Steady edges at the current rate
+        for (int i = 0; i < EDGES_BETWEEN_CHANGES; ++i) {
+            if (edge_diff_q32(next, last) != (int64_t)half) {
+                if (failures++ < 5) printf("  steady gap %lld != %llu\n", (long long)edge_diff_q32(next, last), (unsigned long long)half);
+            }
+            last = next;
+            next = step_edge_advance(last, half);
+        }
+
+        // A change lands at a whole microsecond inside the half-period in flight
+        uint64_t new_half = step_half_period_q32(rates[pick_rate(rng)]);
+        std::uniform_int_distribution<uint64_t> pick_now(last.us, next.us - 1);
+        uint64_t now_us = pick_now(rng);
+        StepEdgeTime now = {now_us, 0};
+        StepEdgeTime retimed = step_retime_next_edge(last, half, new_half, now_us);
+
+        int64_t gap = edge_diff_q32(retimed, last);
+        int64_t elapsed = edge_diff_q32(now, last);
+        int64_t shorter = (int64_t)((half < new_half) ? half : new_half);
+        int64_t longer = (int64_t)((half < new_half) ? new_half : half);
+        bool ok = edge_diff_q32(retimed, now) >= 0 && gap > 0
+               && gap >= shorter - CARRY_TOLERANCE_Q32 && gap <= longer + CARRY_TOLERANCE_Q32;
+        if (elapsed > 0) {
+            // remaining / new = 1 - elapsed / old
+            double expected = (1.0 - (double)elapsed / (double)half) * (double)new_half;
+            int64_t carry_error = (int64_t)llabs(edge_diff_q32(retimed, now) - (int64_t)llround(expected));
+            if (carry_error > worst_carry_q32) worst_carry_q32 = carry_error;
+            ok = ok && carry_error <= CARRY_TOLERANCE_Q32;
+        }
+        if (new_half < half) {
+            if ((double)gap / (double)new_half < shortest_speedup) shortest_speedup = (double)gap / (double)new_half;
+        } else if (new_half > half) {
+            if ((double)gap / (double)half < shortest_slowdown) shortest_slowdown = (double)gap / (double)half;
+        }
+        if (!ok && failures++ < 5) {
+            printf("  change %d: old %llu new %llu elapsed %lld gap %lld\n", change,
+                   (unsigned long long)half, (unsigned long long)new_half, (long long)elapsed, (long long)gap);
+        }
+
+        // The retimed edge fires; the alarm carries on at the new rate
+        last = retimed;
+        half = new_half;
+        next = step_edge_advance(last, half);
+    }
+
+    char detail[160];
+    snprintf(detail, sizeof(detail), "%d changes, %d bad, carry error %.2f ns, shortest gap %.3f new (speed-up), %.3f old (slow-down)",
+             RETIME_CHANGES, failures, worst_carry_q32 * 1000.0 / (double)STEP_Q32_ONE_US, shortest_speedup, shortest_slowdown);
+    return report("retime", failures == 0, detail);
+}
+
+static bool check_late_and_fresh() {
+    const uint64_t half = step_half_period_q32(1200.0f);
+    const uint64_t new_half = step_half_period_q32(2400.0f);
+    StepEdgeTime last = {5000000, 0x80000000u};
+    StepEdgeTime due = step_edge_advance(last, half);
+
+    // The edge was due before the change got in: fire it now, not a half-period late
+    StepEdgeTime late = step_retime_next_edge(last, half, new_half, due.us + 3);
+    bool ok = late.us == due.us + 3 && late.frac == 0;
+
+    // No edge in flight (timer was stopped): a full new half-period from now
+    StepEdgeTime fresh = step_retime_next_edge(last, 0, new_half, last.us + 100);
+    StepEdgeTime expected = step_edge_advance({last.us + 100, 0}, new_half);
+    ok = ok && fresh.us == expected.us && fresh.frac == expected.frac;
+
+    // "Now" in the edge's microsecond but before its fraction: a full new half-period from the edge
+    StepEdgeTime early = step_retime_next_edge(last, half, new_half, last.us);
+    expected = step_edge_advance(last, new_half);
+    ok = ok && early.us == expected.us && early.frac == expected.frac;
+
+    return report("late", ok, "a due edge fires at once; no phase gives a full new half-period");
+}
+
+// --- Entry Point ---
+
+int main() {
+    bool ok = true;
+    const uint32_t high_count = step_pio_high_count(PULSE_HIGH_CYCLES);
+
+    ok &= check_round_trip(high_count);
+    ok &= check_round_trip(0);
+    ok &= check_clamp(high_count);
+    ok &= check_pps(high_count);
+    ok &= check_retime();
+    ok &= check_late_and_fresh();
+
+    return ok ? 0 : 1;
+}
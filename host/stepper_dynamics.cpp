@@ -0,0 +1,122 @@
+#include "stepper_dynamics.h"
+#include <cmath>
+
+// --- Module-Internal Helper Functions ---
+
+static double sim_step_angle(const StepperSim* sim) {
+    return 2.0 * M_PI / (double)sim->params.steps_per_rev; // One full step (rad)
+}
+
+static void sim_select_mode(StepperSim* sim, size_t current) {
+    const StepperDriveConfig& drive = sim->drive;
+    sim->mode = (drive.mode_count > 1)
+        ? microstep_select(drive.modes, drive.mode_count, current, sim->planner.speed, drive.max_pulse_pps)
+        : 0;
+    planner_set_step_distance(&sim->planner, 1.0f / drive.modes[sim->mode].microsteps);
+}
+
+// Plans and outputs one STEP pulse, as the motor core's step path would
+static void sim_emit_pulse(StepperSim* sim) {
+    float interval = planner_next_interval(&sim->planner);
+    if (interval <= 0.0f) {
+        sim->running = false; // Planner stopped: no pulse (the firmware queues a stop word)
+        return;
+    }
+    sim->command_angle += sim->planner.step_distance * sim_step_angle(sim);
+    sim->pulses++;
+    sim->next_step_s += interval * sim->rate_scale;
+    sim_select_mode(sim, sim->mode); // Takes effect from the next pulse
+}
+
+// Pull-out torque amplitude at the given speed
+static double sim_torque_amplitude(const StepperSim* sim, double velocity) {
+    double full_steps_per_s = fabs(velocity) / sim_step_angle(sim);
+    double ratio = full_steps_per_s / sim->params.corner_pps;
+    return sim->params.holding_torque_nm / sqrt(1.0 + ratio * ratio);
+}
+
+static void sim_integrate(StepperSim* sim, double dt) {
+    const StepperDynamicsParams& p = sim->params;
+    double teeth = p.steps_per_rev / 4.0;
+    double inertia = p.rotor_inertia_kgm2 + p.load_inertia_kgm2;
+    double w = sim->velocity;
+    double friction = p.friction_nm + sim->brake_torque_nm;
+
+    double torque = sim_torque_amplitude(sim, w) * sin(teeth * (sim->command_angle - sim->angle));
+    torque -= p.viscous_nms * w + p.drag_nms2 * w * fabs(w);
+    if (w == 0.0 && fabs(torque) <= friction) {
+        return; // Static friction holds the rotor
+    }
+    double direction = (w != 0.0) ? w : torque;
+    torque -= (direction > 0.0) ? friction : -friction;
+
+    // Semi-implicit Euler. A zero crossing stops the rotor for one step, so that
+    // friction alone can never reverse it; the static check above then decides.
+    double w_next = w + torque / inertia * dt;
+    if ((w > 0.0 && w_next < 0.0) || (w < 0.0 && w_next > 0.0)) {
+        w_next = 0.0;
+    }
+    sim->velocity = w_next;
+    sim->angle += w_next * dt;
+
+    float lag = fabsf(stepper_sim_lag_steps(sim));
+    if (lag > sim->max_lag_steps) sim->max_lag_steps = lag;
+}
+
+// --- Public Function Implementations ---
+
+void stepper_sim_init(StepperSim* sim, const StepperDynamicsParams& params,
+                      const StepperDriveConfig& drive, double dt_s) {
+    sim->params = params;
+    sim->drive = drive;
+    planner_init(&sim->planner, drive.limits);
+    sim->mode = 0;
+    planner_set_step_distance(&sim->planner, 1.0f / drive.modes[0].microsteps);
+    sim->running = false;
+    sim->time_s = 0.0;
+    sim->dt_s = dt_s;
+    sim->next_step_s = 0.0;
+    sim->command_angle = 0.0;
+    sim->angle = 0.0;
+    sim->velocity = 0.0;
+    sim->pulses = 0;
+    sim->rate_scale = 1.0f;
+    sim->brake_torque_nm = 0.0f;
+    sim->max_lag_steps = 0.0f;
+}
+
+void stepper_sim_set_target(StepperSim* sim, float pps) {
+    if (pps > 0.0f) {
+        if (!sim->running) {
+            planner_start(&sim->planner, pps);
+            sim_select_mode(sim, 0);
+            sim->next_step_s = sim->time_s;
+            sim->running = true;
+        } else {
+            planner_set_target(&sim->planner, pps);
+        }
+    } else if (sim->running) {
+        planner_set_target(&sim->planner, 0.0f);
+    }
+}
+
+void stepper_sim_advance_to(StepperSim* sim, double time_s) {
+    while (sim->time_s < time_s) {
+        double dt = sim->dt_s;
+        if (sim->time_s + dt > time_s) dt = time_s - sim->time_s;
+        // Pulses due within this step are applied at its start (dt << STEP period)
+        while (sim->running && sim->next_step_s <= sim->time_s + 0.5 * dt) {
+            sim_emit_pulse(sim);
+        }
+        sim_integrate(sim, dt);
+        sim->time_s += dt;
+    }
+}
+
+float stepper_sim_lag_steps(const StepperSim* sim) {
+    return (float)((sim->command_angle - sim->angle) / sim_step_angle(sim));
+}
+
+int64_t stepper_sim_lost_steps(const StepperSim* sim) {
+    return 4 * (int64_t)floor(stepper_sim_lag_steps(sim) / 4.0f + 0.5f);
+}
@@ -0,0 +1,97 @@
+#ifndef STEPPER_DYNAMICS_H
+#define STEPPER_DYNAMICS_H
+
+/**
+ * @file stepper_dynamics.h
+ * @brief Host-side model of the stepper driving the centrifuge arm (Linux build only).
+ *
+ * The step sequence comes from the firmware's own planner code (motion_planner,
+ * microstep selection), fed with the same target changes motor_set_target_frequency
+ * receives. Each STEP pulse advances the commanded field angle by one microstep;
+ * the rotor and the rigidly coupled arm follow through the motor's torque:
+ *
+ *     J dw/dt = T_po(w) sin(Nr (theta_cmd - theta)) - friction - viscous w - drag w^2
+ *
+ * with Nr = full steps per revolution / 4 (rotor teeth) and a pull-out torque that
+ * falls with speed, T_po = T_hold / sqrt(1 + (f / f_corner)^2) for a full-step rate f.
+ * Once the field leads the rotor by more than half an electrical cycle the rotor
+ * slips, and every slipped cycle is four lost full steps.
+ */
+
+#include "motion_planner.h"
+#include "microstep.h"
+#include <cstddef>
+#include <cstdint>
+
+// --- Public Types ---
+
+// Mechanical and electrical constants of the motor and its load
+struct StepperDynamicsParams {
+    float holding_torque_nm;   // Torque amplitude at standstill
+    float corner_pps;          // Full-step rate where the torque has dropped to 1/sqrt(2)
+    float rotor_inertia_kgm2;
+    float load_inertia_kgm2;   // Arm, payload and coupling, referred to the motor shaft
+    float friction_nm;         // Coulomb friction (bearings, slip ring)
+    float viscous_nms;         // Viscous damping (bearings and driver current decay)
+    float drag_nms2;           // Aerodynamic drag of the arm, T = drag * w^2
+    uint32_t steps_per_rev;    // Full steps per revolution
+};
+
+// The firmware side: what the motor core would do with the targets
+struct StepperDriveConfig {
+    MotionLimits limits;
+    const MicrostepMode* modes; // Finest first, as in the axis Config
+    size_t mode_count;
+    float max_pulse_pps;        // Ignored with a single mode
+};
+
+// Simulation state; advance with stepper_sim_advance_to()
+struct StepperSim {
+    StepperDynamicsParams params;
+    StepperDriveConfig drive;
+    MotionPlanner planner;
+    size_t mode;               // Microstep mode in use
+    bool running;              // Steps are being generated
+    double time_s;
+    double dt_s;               // Integration step
+    double next_step_s;        // Time of the next STEP pulse
+    double command_angle;      // Field angle commanded by the pulses so far (rad)
+    double angle;              // Rotor angle (rad)
+    double velocity;           // Rotor angular velocity (rad/s)
+    uint64_t pulses;           // STEP pulses output
+    float rate_scale;          // Applied to planned intervals (speed loop correction), 1 = none
+    float brake_torque_nm;     // Extra friction torque, for disturbance tests
+    float max_lag_steps;       // Largest |command - rotor| seen, in full steps
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Sets up a stopped simulation at t = 0.
+ * @param dt_s Integration step; must be well below the STEP period (10 us is plenty).
+ */
+void stepper_sim_init(StepperSim* sim, const StepperDynamicsParams& params,
+                      const StepperDriveConfig& drive, double dt_s);
+
+/**
+ * @brief Same effect as motor_set_target_frequency() at the current simulation time.
+ * @param pps Target in full steps per second; 0 ramps down and stops.
+ */
+void stepper_sim_set_target(StepperSim* sim, float pps);
+
+/**
+ * @brief Runs the planner and the mechanics up to the given time.
+ */
+void stepper_sim_advance_to(StepperSim* sim, double time_s);
+
+/**
+ * @brief Lag of the rotor behind the commanded angle, in full steps.
+ */
+float stepper_sim_lag_steps(const StepperSim* sim);
+
+/**
+ * @brief Full steps lost so far: the lag rounded to whole electrical cycles (4 full steps).
+ */
+int64_t stepper_sim_lost_steps(const StepperSim* sim);
+
+#endif // STEPPER_DYNAMICS_H
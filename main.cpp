@@ -9,9 +9,10 @@
 #include "StepperMotor.h"
 #include "SerialMenu.h"
 #include "sd_card_manager.h" // Include SD manager header (though init is now manual)
+#include "config_store.h"
 
 // --- Configuration ---
-// How often the main loop checks motor state and input (milliseconds)
+// How often the main loop reports motor state changes (milliseconds)
 const uint MAIN_LOOP_UPDATE_INTERVAL_MS = 20;
 
 // --- Function Declarations (main scope) ---
@@ -48,9 +49,9 @@ void system_setup() {
 
     // Initialize our modules
     motor_init(); // Initializes motor GPIO and state
+    config_store_init(); // Saved settings, read by the modules below
     servo_init(); 
-
-    // SerialMenu doesn't require explicit init currently
+    menu_init();
 
     // *** SD Card initialization is now handled manually via the SerialMenu ***
     // *** Do NOT call sd_init() here anymore ***
@@ -87,24 +88,24 @@ int main() {
              menu_handle_input((char)c); // This now handles SD commands too
         }
 
-        // 2. Update Motor State Periodically (Time-Based Task)
+        // 2. Report Motor State Periodically (Time-Based Task)
+        // The motor runs on core1; this only prints its state changes
         uint64_t now = time_us_64();
         MotorState currentMotorState = motor_get_state(); // Get state from module
 
-        if ( currentMotorState != MOTOR_STOPPED ) {
-             if (now - last_motor_update_time >= (uint64_t)MAIN_LOOP_UPDATE_INTERVAL_MS * 1000) {
-                 motor_update_state();
-                 last_motor_update_time = now;
-            }
-        } else {
+        if (now - last_motor_update_time >= (uint64_t)MAIN_LOOP_UPDATE_INTERVAL_MS * 1000) {
+            motor_update_state();
             last_motor_update_time = now;
         }
 
-        // 3. Update Onboard LED (Simple Output/Status Indicator)
+        // 3. Flash settings upkeep (sector erases only while the motor is stopped)
+        config_store_service(currentMotorState == MOTOR_STOPPED);
+
+        // 4. Update Onboard LED (Simple Output/Status Indicator)
         // LED is ON if motor is doing anything
         gpio_put(PICO_DEFAULT_LED_PIN, (currentMotorState != MOTOR_STOPPED));
 
-        // 4. Small Delay (Yield CPU Time)
+        // 5. Small Delay (Yield CPU Time)
         sleep_us(100);
     }
 
@@ -0,0 +1,57 @@
+#ifndef MICROSTEP_H
+#define MICROSTEP_H
+
+/**
+ * @file microstep.h
+ * @brief Speed-based microstep mode selection with hysteresis.
+ *
+ * An axis lists the driver modes it may use, finest first. Speeds are in full
+ * steps per second; a mode with N microsteps needs N STEP pulses per full step.
+ * The finest mode whose pulse rate stays under the axis limit is used, and a
+ * finer mode is only returned to once its pulse rate would be comfortably below
+ * the limit, so the mode does not chatter around a threshold.
+ * Nothing in here touches the Pico SDK.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+// --- Public Configuration ---
+
+// A finer mode is taken back only below this fraction of the pulse rate limit
+constexpr float MICROSTEP_DOWNSHIFT_FRACTION = 0.75f;
+
+// --- Public Types ---
+
+// One driver microstep setting
+struct MicrostepMode {
+    uint16_t microsteps; // STEP pulses per full step (a power of two)
+    uint8_t ms_bits;     // MS pin levels: bit 0 = MS1, bit 1 = MS2, bit 2 = MS3
+};
+
+// --- Public Functions ---
+
+/**
+ * @brief Picks the microstep mode for a speed.
+ * @param modes Available modes, finest first (microsteps strictly decreasing).
+ * @param count Number of modes.
+ * @param current Index of the mode in use.
+ * @param full_steps_per_s Speed in full steps per second.
+ * @param max_pulse_pps Highest STEP pulse rate the axis should run at.
+ * @return Index of the mode to use (current if no change is due).
+ */
+constexpr size_t microstep_select(const MicrostepMode* modes, size_t count, size_t current,
+                                  float full_steps_per_s, float max_pulse_pps) {
+    // Coarser while the pulse rate is over the limit (the coarsest mode always stays)
+    while (current + 1 < count && full_steps_per_s * modes[current].microsteps > max_pulse_pps) {
+        ++current;
+    }
+    // Finer once the finer mode has headroom
+    while (current > 0 &&
+           full_steps_per_s * modes[current - 1].microsteps < max_pulse_pps * MICROSTEP_DOWNSHIFT_FRACTION) {
+        --current;
+    }
+    return current;
+}
+
+#endif // MICROSTEP_H
@@ -0,0 +1,179 @@
+#include "motion_planner.h"
+#include <cmath> // For sqrtf, fabsf
+
+// --- Module-Internal Helper Functions ---
+
+static void planner_clear_band_stats(MotionPlanner* planner) {
+    planner->current_band = -1;
+    for (int i = 0; i < PLANNER_MAX_BANDS; ++i) {
+        planner->band_time_s[i] = 0.0f;
+        planner->band_crossings[i] = 0;
+    }
+}
+
+// A target inside a band becomes the band edge on the side the motor is on, so
+// the planner settles next to the band instead of in it (and does not cross it
+// unless the target moves past the far edge).
+static float planner_hold_target(const MotionLimits& lim, float target, float v) {
+    int band = planner_band_at(lim, target);
+    if (band < 0) {
+        return target;
+    }
+    const PlannerBand& b = lim.bands[band];
+    if (v <= b.low_pps) return b.low_pps;
+    if (v >= b.high_pps) return b.high_pps;
+    // Already crossing: finish towards the nearer edge
+    return (target - b.low_pps < b.high_pps - target) ? b.low_pps : b.high_pps;
+}
+
+// --- Public Function Implementations ---
+
+int planner_band_at(const MotionLimits& limits, float pps) {
+    for (int i = 0; i < PLANNER_MAX_BANDS; ++i) {
+        const PlannerBand& b = limits.bands[i];
+        if (b.high_pps > b.low_pps && pps > b.low_pps && pps < b.high_pps) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void planner_init(MotionPlanner* planner, const MotionLimits& limits) {
+    planner->limits = limits;
+    planner->target = 0.0f;
+    planner->speed = 0.0f;
+    planner->accel = 0.0f;
+    planner->step_distance = 1.0f;
+    planner_clear_band_stats(planner);
+}
+
+void planner_set_limits(MotionPlanner* planner, const MotionLimits& limits) {
+    planner->limits = limits;
+}
+
+void planner_set_step_distance(MotionPlanner* planner, float full_steps) {
+    if (full_steps > 0.0f) {
+        planner->step_distance = full_steps;
+    }
+}
+
+void planner_start(MotionPlanner* planner, float target_pps) {
+    planner_clear_band_stats(planner);
+    if (target_pps <= 0.0f) {
+        planner->target = 0.0f;
+        planner->speed = 0.0f;
+        planner->accel = 0.0f;
+        return;
+    }
+    planner->target = target_pps;
+    planner->speed = (target_pps < planner->limits.start_pps) ? target_pps : planner->limits.start_pps;
+    planner->accel = 0.0f;
+}
+
+void planner_set_target(MotionPlanner* planner, float target_pps) {
+    planner->target = (target_pps > 0.0f) ? target_pps : 0.0f;
+}
+
+void planner_halt(MotionPlanner* planner) {
+    planner->target = 0.0f;
+    planner->speed = 0.0f;
+    planner->accel = 0.0f;
+    planner->current_band = -1;
+}
+
+/*
+ * Each call covers exactly one step of d = step_distance, so acceleration is
+ * applied per step rather than per unit time: with constant acceleration a over it,
+ *     v_next^2 = v^2 + 2ad
+ *     interval = 2d / (v + v_next)   (exact time to cover it)
+ * This is the exact form of Austin's c_n = c_{n-1} - 2c_{n-1}/(4n+1) recurrence,
+ * and stays correct when a changes between steps, which the S-curve needs.
+ *
+ * The acceleration itself is jerk limited: it moves towards the largest value
+ * that can still be wound back to zero (at max_jerk) by the time the speed
+ * reaches the target, and never changes faster than max_jerk.
+ *
+ * Inside a resonance band the jerk limit is dropped and the band is crossed at
+ * the full acceleration/deceleration limit; targets are never left inside a band.
+ */
+float planner_next_interval(MotionPlanner* planner) {
+    float v = planner->speed;
+    if (v <= 0.0f) {
+        return 0.0f;
+    }
+
+    const MotionLimits& lim = planner->limits;
+    float d = planner->step_distance;
+    float target = planner->target;
+    // Stopping ramps down to the pull-in speed, from where the motor can stop dead;
+    // below it the motor already can, so it stops once the acceleration is wound out
+    float ramp_target = (target > 0.0f) ? target : fminf(v, lim.start_pps);
+    ramp_target = planner_hold_target(lim, ramp_target, v);
+    float dv = ramp_target - v;
+
+    if (dv == 0.0f && planner->accel == 0.0f) {
+        if (target <= 0.0f) {
+            planner->speed = 0.0f; // Last step at the pull-in speed
+        }
+        return d / v; // Cruising (or final step)
+    }
+
+    // Acceleration that can still be brought back to 0 by the time v reaches the target
+    float accel_limit = (dv > 0.0f) ? lim.max_accel : lim.max_decel;
+    float accel_wanted = sqrtf(2.0f * lim.max_jerk * fabsf(dv));
+    if (accel_wanted > accel_limit) accel_wanted = accel_limit;
+    if (dv < 0.0f) accel_wanted = -accel_wanted;
+
+    float accel = planner->accel;
+    if (planner_band_at(lim, v) >= 0) {
+        // Resonance band: spend as little time in it as the limits allow
+        accel = (dv > 0.0f) ? accel_limit : -accel_limit;
+    } else {
+        // Jerk limit over the time of this step
+        float max_change = lim.max_jerk * d / v;
+        if (accel_wanted > accel + max_change) {
+            accel += max_change;
+        } else if (accel_wanted < accel - max_change) {
+            accel -= max_change;
+        } else {
+            accel = accel_wanted;
+        }
+    }
+
+    float v_next_sq = v * v + 2.0f * accel * d;
+    float v_next = (v_next_sq > 0.0f) ? sqrtf(v_next_sq) : 0.0f;
+
+    // Land exactly on the target instead of overshooting it
+    if ((dv > 0.0f && v_next >= ramp_target) || (dv < 0.0f && v_next <= ramp_target)) {
+        v_next = ramp_target;
+        accel = 0.0f;
+    }
+
+    float interval = 2.0f * d / (v + v_next);
+    planner->speed = v_next;
+    planner->accel = accel;
+
+    // Band statistics: the step belongs to the band its mean speed is in
+    int band = planner_band_at(lim, 0.5f * (v + v_next));
+    if (band >= 0) {
+        if (band != planner->current_band) {
+            planner->band_crossings[band]++;
+        }
+        planner->band_time_s[band] += interval;
+    }
+    planner->current_band = band;
+    return interval;
+}
+
+float planner_held_target(const MotionPlanner* planner) {
+    float target = planner->target;
+    return (target > 0.0f) ? planner_hold_target(planner->limits, target, planner->speed) : target;
+}
+
+bool planner_is_settled(const MotionPlanner* planner) {
+    return planner->target > 0.0f && planner->accel == 0.0f && planner->speed == planner_held_target(planner);
+}
+
+bool planner_is_stopped(const MotionPlanner* planner) {
+    return planner->speed <= 0.0f;
+}
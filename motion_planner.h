@@ -0,0 +1,118 @@
+#ifndef MOTION_PLANNER_H
+#define MOTION_PLANNER_H
+
+/**
+ * @file motion_planner.h
+ * @brief Jerk-limited (S-curve) per-step speed planner for the stepper.
+ *
+ * The planner is advanced once per step from the step path and returns the
+ * interval until the next step, so ramps are resolved per step instead of per
+ * main-loop tick. Speeds are in full steps per second; each planned step covers
+ * step_distance full steps, so a microstepping axis plans one call per pulse.
+ * Pure C++ with no SDK dependencies.
+ */
+
+#include <stdint.h>
+
+// --- Public Configuration ---
+const int PLANNER_MAX_BANDS = 4; // Forbidden (resonance) speed bands
+
+// --- Public Types ---
+
+// Speed band the motor may pass through but never hold a speed in.
+// Inactive unless high_pps > low_pps.
+struct PlannerBand {
+    float low_pps;
+    float high_pps;
+};
+
+// Limits the planner respects. All rates are in steps (pulses) per second.
+struct MotionLimits {
+    float max_accel;   // Maximum acceleration while speeding up (PPS per second)
+    float max_decel;   // Maximum deceleration while slowing down (PPS per second)
+    float max_jerk;    // Maximum rate of change of acceleration (PPS per second^2)
+    float start_pps;   // Speed the motor can start/stop at instantly (pull-in rate)
+    PlannerBand bands[PLANNER_MAX_BANDS]; // Resonance bands, crossed at full accel/decel
+};
+
+// Planner state. Only the step path advances it; other code sets the target.
+struct MotionPlanner {
+    MotionLimits limits;
+    volatile float target; // Target speed (PPS)
+    float speed;           // Speed of the step just planned (PPS), 0 when stopped
+    float accel;           // Current acceleration (PPS/s)
+    float step_distance;   // Full steps covered by one planned step (1 / microsteps)
+    int current_band;      // Band the last step was in, -1 if none
+    float band_time_s[PLANNER_MAX_BANDS];       // Time spent inside each band since planner_start
+    uint32_t band_crossings[PLANNER_MAX_BANDS]; // Entries into each band since planner_start
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Returns the band containing the speed (strictly inside), or -1.
+ */
+int planner_band_at(const MotionLimits& limits, float pps);
+
+/**
+ * @brief Initialises the planner, stopped, with the given limits and whole-step distance.
+ */
+void planner_init(MotionPlanner* planner, const MotionLimits& limits);
+
+/**
+ * @brief Replaces the limits (takes effect on the next planned step).
+ */
+void planner_set_limits(MotionPlanner* planner, const MotionLimits& limits);
+
+/**
+ * @brief Sets the distance of the following planned steps (e.g. after a microstep mode change).
+ * The speed is unaffected, so only the step interval scales.
+ * @param full_steps Full steps per planned step, > 0.
+ */
+void planner_set_step_distance(MotionPlanner* planner, float full_steps);
+
+/**
+ * @brief Starts a stopped planner at its pull-in speed (or the target, if lower).
+ * Also clears the band crossing statistics, so they cover one run.
+ * @param target_pps Speed to ramp to.
+ */
+void planner_start(MotionPlanner* planner, float target_pps);
+
+/**
+ * @brief Changes the target speed. Safe to call while the step path is running.
+ * A target inside a resonance band is held at the band edge on the current side.
+ * @param target_pps New target. 0 ramps down to the pull-in speed and then stops; below
+ *        the pull-in speed it winds out the acceleration and stops without speeding up.
+ */
+void planner_set_target(MotionPlanner* planner, float target_pps);
+
+/**
+ * @brief Stops the planner at once, without a ramp (fault stops only; the motor is
+ * no longer following the steps anyway). Band statistics are kept.
+ */
+void planner_halt(MotionPlanner* planner);
+
+/**
+ * @brief Plans one step.
+ * @return Interval in seconds between this step and the next, or 0 if the planner is stopped.
+ */
+float planner_next_interval(MotionPlanner* planner);
+
+/**
+ * @brief Speed the planner is heading for: the target, or the band edge it is held at
+ * while the target is inside a resonance band.
+ */
+float planner_held_target(const MotionPlanner* planner);
+
+/**
+ * @brief True once the planner is cruising at a non-zero (held) target with no acceleration.
+ * In this state every further interval is step_distance/speed, so the step backend can just repeat it.
+ */
+bool planner_is_settled(const MotionPlanner* planner);
+
+/**
+ * @brief True if the planner has no more steps to produce.
+ */
+bool planner_is_stopped(const MotionPlanner* planner);
+
+#endif // MOTION_PLANNER_H
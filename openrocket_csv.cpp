@@ -0,0 +1,432 @@
+#include "openrocket_csv.h"
+#include "float_parse.h"
+
+#include <vector>              // For std::vector to store parsed data
+#include <cstring>             // For memcmp, memchr, memcpy, strlen
+#include <cstdio>              // For printf
+#include <cmath> // For sqrt, M_PI
+
+
+// --- Static Storage for Parsed Data ---
+// This vector will hold the data points after parsing
+static std::vector<FlightDataPoint> parsed_flight_data;
+
+// Progress of the parse, kept between the pieces of a chunked parse
+static bool s_found_ignition = false;
+static bool s_found_apogee = false;  // Everything after it is ignored
+
+// Column selection, by name, and where the header put those columns
+static char s_time_column[CSV_COLUMN_NAME_MAX] = CSV_DEFAULT_TIME_COLUMN;
+static char s_acceleration_column[CSV_COLUMN_NAME_MAX] = CSV_DEFAULT_ACCELERATION_COLUMN;
+static int s_time_field = 0;              // Field numbers in the current file
+static int s_acceleration_field = 1;
+static int s_last_field = 1;              // Fields after this one are never looked at
+static float s_acceleration_to_g = 1.0f;  // From the header's unit
+static bool s_columns_missing = false;    // The header lacks a selected column
+
+// Where the field numbers came from. Once a header names both selected columns,
+// later comment lines are not headers; a 2-column header without the names is
+// read by position, and only a header that names them replaces that.
+enum ColumnSource { COLUMNS_DEFAULT, COLUMNS_BY_POSITION, COLUMNS_BY_NAME };
+static ColumnSource s_column_source = COLUMNS_DEFAULT;
+
+static const float STANDARD_GRAVITY_MPS2 = 9.80665f;
+static const float METERS_PER_FOOT = 0.3048f;
+
+// --- Line Scanning Helpers ---
+// The input may be memory-mapped flash: lines are a pointer and a length into it,
+// never NUL-terminated copies, and the input is never written.
+
+// Finds the next non-empty line (separators \n and \r, as strtok did)
+static bool next_line(const char** cursor, const char* end, const char** line, size_t* length) {
+    const char* p = *cursor;
+    while (p < end && (*p == '\n' || *p == '\r')) ++p;
+    if (p == end) {
+        *cursor = p;
+        return false;
+    }
+    const char* line_end = p;
+    while (line_end < end && *line_end != '\n' && *line_end != '\r') ++line_end;
+    *line = p;
+    *length = (size_t)(line_end - p);
+    *cursor = line_end;
+    return true;
+}
+
+static bool line_starts_with(const char* line, size_t length, const char* prefix) {
+    size_t prefix_length = strlen(prefix);
+    return length >= prefix_length && memcmp(line, prefix, prefix_length) == 0;
+}
+
+static bool line_contains(const char* line, size_t length, const char* text) {
+    size_t text_length = strlen(text);
+    for (size_t i = 0; i + text_length <= length; ++i) {
+        if (line[i] == text[0] && memcmp(line + i, text, text_length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+static char lower_case(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// Header line: a comment with commas that is not an event ("# Time (s),Altitude (m),...")
+static bool line_is_column_header(const char* line, size_t length) {
+    return length > 0 && line[0] == '#' && !line_starts_with(line, length, "# Event")
+        && memchr(line, ',', length) != nullptr;
+}
+
+// Header field text without the blanks around it
+static void trim_field(const char* start, const char* end, const char** field, size_t* length) {
+    while (start < end && is_blank(*start)) ++start;
+    while (end > start && is_blank(end[-1])) --end;
+    *field = start;
+    *length = (size_t)(end - start);
+}
+
+// Same text ignoring case, with nothing after it but an optional "(unit)"
+static bool column_matches(const char* field, size_t length, const char* name) {
+    size_t name_length = strlen(name);
+    if (length < name_length) {
+        return false;
+    }
+    for (size_t i = 0; i < name_length; ++i) {
+        if (lower_case(field[i]) != lower_case(name[i])) {
+            return false;
+        }
+    }
+    size_t rest = name_length;
+    while (rest < length && is_blank(field[rest])) ++rest;
+    return rest == length || field[rest] == '(';
+}
+
+// Factor to G for the unit in a header field's "(...)"; no unit means G
+static float acceleration_unit_to_g(const char* field, size_t length) {
+    const char* open = (const char*)memchr(field, '(', length);
+    if (!open) {
+        return 1.0f;
+    }
+    const char* unit = open + 1;
+    size_t unit_length = (size_t)(field + length - unit);
+    const char* close = (const char*)memchr(unit, ')', unit_length);
+    if (close) unit_length = (size_t)(close - unit);
+
+    if (unit_length == 1 && (unit[0] == 'G' || unit[0] == 'g')) {
+        return 1.0f;
+    }
+    if (line_starts_with(unit, unit_length, "m/s")) {   // m/s², m/s^2, m/s2
+        return 1.0f / STANDARD_GRAVITY_MPS2;
+    }
+    if (line_starts_with(unit, unit_length, "ft/s")) {
+        return METERS_PER_FOOT / STANDARD_GRAVITY_MPS2;
+    }
+    printf("Warning: Unknown acceleration unit '%.*s', read as G.\n", (int)unit_length, unit);
+    return 1.0f;
+}
+
+static void print_columns(const char* line, size_t length) {
+    const char* p = line + 1; // Past the '#'
+    const char* end = line + length;
+    for (int field_number = 0; ; ++field_number) {
+        const char* comma = (const char*)memchr(p, ',', (size_t)(end - p));
+        const char* field;
+        size_t field_length;
+        trim_field(p, comma ? comma : end, &field, &field_length);
+        printf("  %d: %.*s\n", field_number, (int)field_length, field);
+        if (!comma) break;
+        p = comma + 1;
+    }
+}
+
+// Finds the selected columns in a header line
+static void map_columns(const char* line, size_t length) {
+    if (s_column_source == COLUMNS_BY_NAME) {
+        return; // The header has been read; this is just a comment with a comma
+    }
+    const char* p = line + 1; // Past the '#'
+    const char* end = line + length;
+    int time_field = -1;
+    int acceleration_field = -1;
+    float acceleration_to_g = 1.0f;
+    const char* second_field = nullptr;
+    size_t second_field_length = 0;
+    int field_count = 0;
+    for (int field_number = 0; ; ++field_number) {
+        const char* comma = (const char*)memchr(p, ',', (size_t)(end - p));
+        const char* field;
+        size_t field_length;
+        trim_field(p, comma ? comma : end, &field, &field_length);
+        if (time_field < 0 && column_matches(field, field_length, s_time_column)) {
+            time_field = field_number;
+        }
+        if (acceleration_field < 0 && column_matches(field, field_length, s_acceleration_column)) {
+            acceleration_field = field_number;
+            acceleration_to_g = acceleration_unit_to_g(field, field_length);
+        }
+        if (field_number == 1) {
+            second_field = field;
+            second_field_length = field_length;
+        }
+        field_count = field_number + 1;
+        if (!comma) break;
+        p = comma + 1;
+    }
+
+    if (time_field < 0 || acceleration_field < 0) {
+        if (s_column_source == COLUMNS_BY_POSITION) {
+            return; // A comment after the 2-column header
+        }
+        if (field_count == 2) {
+            // A hand-trimmed time,acceleration file ("# Time (s),Acceleration (G)")
+            s_time_field = 0;
+            s_acceleration_field = 1;
+            s_last_field = 1;
+            s_acceleration_to_g = acceleration_unit_to_g(second_field, second_field_length);
+            s_columns_missing = false;
+            s_column_source = COLUMNS_BY_POSITION;
+            printf("Warning: '%s' or '%s' is not in the 2-column header; reading it as time,acceleration.\n",
+                   s_time_column, s_acceleration_column);
+            return;
+        }
+    }
+
+    if (time_field < 0 || acceleration_field < 0) {
+        printf("Error: Column '%s' is not in the header. The columns are:\n",
+               (time_field < 0) ? s_time_column : s_acceleration_column);
+        print_columns(line, length);
+        s_columns_missing = true;
+        return;
+    }
+    s_time_field = time_field;
+    s_acceleration_field = acceleration_field;
+    s_last_field = (time_field > acceleration_field) ? time_field : acceleration_field;
+    s_acceleration_to_g = acceleration_to_g;
+    s_columns_missing = false;
+    s_column_source = COLUMNS_BY_NAME;
+    printf("Columns: time is field %d, acceleration is field %d (x%.5f to G).\n",
+           time_field, acceleration_field, acceleration_to_g);
+}
+
+// Reads the selected fields of a data line. The fields before them are skipped
+// with a search for the next comma, and those after them are not looked at.
+static bool parse_data_line(const char* line, size_t length, float* timestamp, float* acceleration) {
+    const char* p = line;
+    const char* end = line + length;
+    for (int field_number = 0; ; ++field_number) {
+        if (field_number == s_time_field || field_number == s_acceleration_field) {
+            float value;
+            size_t used = parse_float(p, (size_t)(end - p), &value);
+            if (used == 0) {
+                return false;
+            }
+            p += used;
+            while (p < end && is_blank(*p)) ++p;
+            if (p < end && *p != ',') {
+                return false; // Something other than a number in the field
+            }
+            if (field_number == s_time_field) *timestamp = value;
+            if (field_number == s_acceleration_field) *acceleration = value * s_acceleration_to_g;
+        }
+        if (field_number == s_last_field) {
+            return true;
+        }
+        const char* comma = (const char*)memchr(p, ',', (size_t)(end - p));
+        if (!comma) {
+            return false; // Too few fields
+        }
+        p = comma + 1;
+    }
+}
+
+// --- CSV Parsing Functions ---
+
+// Parses whole lines, carrying on from where the previous call stopped
+static void parse_lines(const char* data, size_t size) {
+    const char* cursor = data;
+    const char* end = data + size;
+    const char* line;
+    size_t length;
+
+    while (!s_found_apogee && next_line(&cursor, end, &line, &length)) {
+        // --- Logic for finding the start ---
+        if (!s_found_ignition) {
+            if (line_contains(line, length, "# Event IGNITION")) {
+                printf("Found IGNITION event.\n");
+                s_found_ignition = true;
+            } else if (line_is_column_header(line, length)) {
+                map_columns(line, length);
+            }
+            continue; // Skip lines before IGNITION is found
+        }
+
+        // --- Logic after IGNITION is found ---
+
+        // Check for APOGEE first (stops parsing)
+        if (line_contains(line, length, "# Event APOGEE")) {
+            printf("Found APOGEE event. Stopping parse.\n");
+            s_found_apogee = true;
+            break;
+        }
+
+        // Skip any other "# Event" line
+        if (line_starts_with(line, length, "# Event")) {
+             printf("Skipping event line: %.*s\n", (int)length, line);
+             continue;
+        }
+
+        if (s_columns_missing) {
+            continue; // Already reported; the parse fails
+        }
+
+        // Attempt to parse as data: the selected fields, read in place
+        float timestamp = 0.0f;
+        float acceleration = 0.0f;
+        if (parse_data_line(line, length, &timestamp, &acceleration)) {
+            parsed_flight_data.push_back({timestamp, acceleration, 0.0f});
+        } else {
+            printf("Warning: Failed to parse data line: %.*s\n", (int)length, line);
+        }
+    }
+}
+
+bool parse_openrocket_data(const char* data_buffer, size_t data_size) {
+    printf("Parsing flight data (%u bytes)...\n", (unsigned int)data_size);
+    parse_openrocket_begin();
+    parse_openrocket_chunk(data_buffer, data_size, true);
+    return parse_openrocket_end();
+}
+
+void parse_openrocket_begin() {
+    parsed_flight_data.clear();
+    s_found_ignition = false;
+    s_found_apogee = false;
+    // Without a header line: time,acceleration in G
+    s_time_field = 0;
+    s_acceleration_field = 1;
+    s_last_field = 1;
+    s_acceleration_to_g = 1.0f;
+    s_columns_missing = false;
+    s_column_source = COLUMNS_DEFAULT;
+}
+
+size_t parse_openrocket_chunk(const char* data, size_t size, bool is_last) {
+    if (s_found_apogee) {
+        return size; // Done: the rest of the input is not needed
+    }
+    size_t complete = size;
+    if (!is_last) {
+        while (complete > 0 && data[complete - 1] != '\n' && data[complete - 1] != '\r') --complete;
+    }
+    parse_lines(data, complete);
+    return s_found_apogee ? size : complete;
+}
+
+bool parse_openrocket_end() {
+    printf("Parsing finished. Found %u data points.\n", (unsigned int)parsed_flight_data.size());
+    return s_found_ignition && !s_columns_missing; // Success if we at least found ignition
+}
+
+bool set_openrocket_columns(const char* time_column, const char* acceleration_column) {
+    size_t time_length = strlen(time_column);
+    size_t acceleration_length = strlen(acceleration_column);
+    if (time_length == 0 || time_length >= CSV_COLUMN_NAME_MAX
+        || acceleration_length == 0 || acceleration_length >= CSV_COLUMN_NAME_MAX) {
+        return false;
+    }
+    memcpy(s_time_column, time_column, time_length + 1);
+    memcpy(s_acceleration_column, acceleration_column, acceleration_length + 1);
+    return true;
+}
+
+const char* get_openrocket_time_column() {
+    return s_time_column;
+}
+
+const char* get_openrocket_acceleration_column() {
+    return s_acceleration_column;
+}
+
+
+// --- Accessor Functions for Parsed Data ---
+
+size_t get_parsed_data_count() {
+    return parsed_flight_data.size();
+}
+
+FlightDataPoint get_parsed_data_point(size_t index) {
+    if (index < parsed_flight_data.size()) {
+        return parsed_flight_data[index];
+    }
+    // Return a default/invalid point if index is out of bounds
+    printf("Warning: Requested parsed data index %u out of bounds (size %u).\n",
+           (unsigned int)index, (unsigned int)parsed_flight_data.size());
+    return {0.0f, 0.0f, 0.0f};
+}
+
+bool calculate_pps_for_parsed_data(float radius_m) {
+    const float G_ACCEL = 9.80665f; // m/s^2
+    const float RPM_TO_PPS_FACTOR = 0.3f; // From user: RPM = PPS * 0.3 => PPS = RPM / 0.3
+
+    if (radius_m <= 0.0f) {
+        printf("Error: Invalid radius (%.3f m) for PPS calculation.\n", radius_m);
+        return false;
+    }
+    if (parsed_flight_data.empty()) {
+        printf("Warning: No parsed data available to calculate PPS.\n");
+        return false;
+    }
+
+    printf("Calculating Target PPS for %u points with radius %.3f m (Map Gs->RPM->PPS)...\n", // Updated message
+           (unsigned int)parsed_flight_data.size(), radius_m);
+
+    for (FlightDataPoint& point : parsed_flight_data) { // Use reference to modify
+        float target_rpm = 0.0f;
+        float target_pps = 0.0f;
+
+        // Step 1: Calculate target physical angular velocity (omega) in rad/s from Gs
+        float accel_g_abs = fabsf(point.acceleration);
+        float accel_mps2 = accel_g_abs * G_ACCEL;
+        float omega_squared = 0.0f;
+        if (radius_m > 0.0f && accel_mps2 > 0.0f) {
+             omega_squared = accel_mps2 / radius_m;
+        }
+        float omega = 0.0f; // rad/s
+        if (omega_squared > 0.0f) {
+             omega = sqrt(omega_squared);
+        }
+
+        // Step 2: Convert omega (rad/s) to target physical RPM
+        if (omega > 0.0f) {
+            // omega (rad/s) * (60 s / min) / (2*pi rad / rev) = RPM
+            target_rpm = omega * 60.0f / (2.0f * M_PI);
+        } else {
+            target_rpm = 0.0f;
+        }
+
+        // Step 3: Convert target physical RPM to required input PPS using the provided factor
+        if (target_rpm > 0.0f && RPM_TO_PPS_FACTOR != 0.0f) {
+             target_pps = target_rpm / RPM_TO_PPS_FACTOR;
+        } else {
+             target_pps = 0.0f;
+        }
+
+        // Store the final calculated PPS value needed by the motor driver
+        point.target_pps = target_pps;
+
+        // Optional: Print intermediate and final values during debug
+        // printf("  t=%.3f, G=%.3f -> omega=%.3f rad/s -> RPM=%.3f -> PPS=%.3f Hz\n",
+        //        point.timestamp, point.acceleration, omega, target_rpm, point.target_pps);
+    }
+    printf("PPS calculation complete.\n");
+    return true;
+}
+
+void release_parsed_data() {
+    std::vector<FlightDataPoint>().swap(parsed_flight_data);
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#ifndef OPENROCKET_CSV_H
+#define OPENROCKET_CSV_H
+
+/**
+ * @file openrocket_csv.h
+ * @brief Parsing of OpenRocket CSV exports into flight data points, and the
+ * G to step-rate mapping. Pure C++ with no SDK dependencies, so the host tools
+ * load profiles exactly like the firmware does.
+ *
+ * Exports may carry any number of columns. The "# Time (s),Altitude (m),..."
+ * header line before IGNITION maps the selected time and acceleration columns
+ * (by name) to field numbers; data lines then convert only those two fields and
+ * skip past the others without reading their numbers. The acceleration unit is
+ * taken from the header (G, m/s^2 or ft/s^2) and converted to G. The first header
+ * naming both columns is the one used; later comment lines are not headers. A file
+ * with no header line, or a 2-column header without the selected names, is read
+ * as time,acceleration (in G unless the second header field names a unit).
+ */
+
+#include <cstddef> // For size_t
+
+// --- Configuration: Column Selection ---
+const size_t CSV_COLUMN_NAME_MAX = 48;  // Longest column name kept, including the NUL
+#define CSV_DEFAULT_TIME_COLUMN          "Time"
+#define CSV_DEFAULT_ACCELERATION_COLUMN  "Vertical acceleration"
+
+// --- Data Structure for Parsed Flight Data ---
+struct FlightDataPoint {
+    float timestamp;
+    float acceleration; // Original G value
+    float target_pps;   // Calculated Pulses Per Second (Hz) for motor
+};
+
+// --- Function Declarations: CSV Parsing ---
+
+/**
+ * @brief Parses the flight data buffer, in place: the buffer is only read and
+ * needs no terminator, so it can be the memory-mapped flash copy itself.
+ * Stores the selected time and acceleration of each data line between
+ * "# Event IGNITION" and "# Event APOGEE".
+ * @param data_buffer Pointer to the character buffer holding the CSV data.
+ * @param data_size The size of the data in the buffer.
+ * @return True if parsing finished successfully (IGNITION found, and the selected
+ *         columns in the header if there is one), false otherwise.
+ */
+bool parse_openrocket_data(const char* data_buffer, size_t data_size);
+
+/**
+ * @brief Starts a parse fed in pieces (parse_openrocket_chunk), for input that is
+ * read a buffer at a time. Clears the parsed data.
+ */
+void parse_openrocket_begin();
+
+/**
+ * @brief Parses the complete lines of the next piece of input.
+ * @param data The next input; need not be NUL-terminated.
+ * @param size Bytes in data.
+ * @param is_last True for the final piece: its last line counts even without a line end.
+ * @return Bytes used. The rest (a partial last line) must start the next piece;
+ *         0 with is_last false means no line ends in the piece at all.
+ */
+size_t parse_openrocket_chunk(const char* data, size_t size, bool is_last);
+
+/**
+ * @brief Ends a parse fed in pieces.
+ * @return True on success, as parse_openrocket_data().
+ */
+bool parse_openrocket_end();
+
+/**
+ * @brief Selects the columns read by the next parse, by header name. A name
+ * matches a header field with the same text, ignoring case and any
+ * "(unit)" after it: "vertical acceleration" matches "Vertical acceleration (m/s²)".
+ * @return False (selection unchanged) if a name is empty or too long.
+ */
+bool set_openrocket_columns(const char* time_column, const char* acceleration_column);
+
+/**
+ * @brief Gets the selected time column name.
+ */
+const char* get_openrocket_time_column();
+
+/**
+ * @brief Gets the selected acceleration column name.
+ */
+const char* get_openrocket_acceleration_column();
+
+// --- Function Declarations: Accessors for Parsed Data ---
+
+/**
+ * @brief Gets the number of valid data points parsed.
+ * @return The count of stored FlightDataPoints.
+ */
+size_t get_parsed_data_count();
+
+/**
+ * @brief Gets a specific parsed data point by index.
+ * @param index The index of the data point (0 to count-1).
+ * @return The FlightDataPoint at the specified index. Returns {0, 0} if index is out of bounds.
+ */
+FlightDataPoint get_parsed_data_point(size_t index);
+
+/**
+ * @brief Calculates target PPS for all previously parsed data points based on radius.
+ * Populates the target_pps field in the stored FlightDataPoints.
+ * @param radius_m The radius of the centrifuge arm in meters.
+ * @return True on success, false if no data was parsed or radius is invalid.
+ */
+bool calculate_pps_for_parsed_data(float radius_m);
+
+/**
+ * @brief Frees the parsed data, once it has been compiled into a flash profile.
+ */
+void release_parsed_data();
+
+#endif // OPENROCKET_CSV_H
@@ -1,39 +1,127 @@
 #include "openrocket_parser.h" // Include the header file we defined
 #include "sd_card_manager.h"   // For SD card functions [cite: uploaded:my_projects/sd_card_manager.h]
+#include "flip_schedule.h"     // The flips compiled into the profile
+#include "StepperMotor.h"      // For motor_get_state (no flash writes while it runs)
 
 #include "hardware/flash.h"    // For flash operations
-#include "hardware/sync.h"     // For disabling interrupts
+#include "pico/flash.h"        // For flash_safe_execute (pauses the motor core during writes)
 
-#include <vector>              // For std::vector to store parsed data
-#include <string>              // For std::string operations (optional, could use C strings)
-#include <cstring>             // For memcpy, memset, strstr, strtok_r, strlen
+#include <cstring>             // For memcpy, memset, memcmp
 #include <cstdio>              // For printf (debugging)
-#include <cstdlib>             // For malloc, free, strtof (or sscanf)
-#include <cctype>              // For isprint (used in display, but good include)
-#include <cmath> // For sqrt, M_PI
+#include <cstdlib>             // For malloc, free
 
 
-// --- Static Storage for Parsed Data ---
-// This vector will hold the data points after parsing
-static std::vector<FlightDataPoint> parsed_flight_data;
-
 // --- Helper Function ---
 // Calculates size padded up to the nearest flash page boundary
 static inline size_t get_padded_size(size_t size) {
     return (size + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
 }
 
-// --- Flash Storage Functions ---
+// Erase/program work handed to flash_safe_execute, which runs it with the motor
+// core paused (multicore lockout) and interrupts disabled on this core.
+// Each job is one sector erase or one chunk of page programs, so the motor core
+// is never held for more than one of those.
+struct FlashWriteJob {
+    uint32_t offset;     // Flash offset, sector aligned for an erase
+    const uint8_t* data;
+    size_t erase_size;   // 0 or FLASH_SECTOR_SIZE (0 = no erase)
+    size_t program_size; // Multiple of FLASH_PAGE_SIZE (0 = no program)
+};
+
+// Upper bound for pausing the motor core before giving up on a write
+static const uint32_t FLASH_SAFE_TIMEOUT_MS = 100;
+
+// The CSV comes off the SD card, and the profile goes into flash, through one
+// buffer of this size, so the RAM needed does not depend on either size
+static const size_t STORE_CHUNK_SIZE = FLASH_SECTOR_SIZE;
+
+// Latest time a uint32_t microsecond count can hold (about 71 minutes)
+static const double MAX_PROFILE_TIME_S = 4294.0;
+
+static void flash_write_job(void* param) {
+    const FlashWriteJob* job = (const FlashWriteJob*)param;
+    if (job->erase_size > 0) {
+        flash_range_erase(job->offset, job->erase_size);
+    }
+    if (job->program_size > 0) {
+        flash_range_program(job->offset, job->data, job->program_size);
+    }
+}
+
+static bool run_flash_job(const FlashWriteJob& job) {
+    int flash_rc = flash_safe_execute(flash_write_job, (void*)&job, FLASH_SAFE_TIMEOUT_MS);
+    if (flash_rc != PICO_OK) {
+        printf("Error: Flash write could not run safely (error %d).\n", flash_rc);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t seconds_to_us(float seconds) {
+    if (seconds <= 0.0f) {
+        return 0;
+    }
+    return (uint32_t)((double)seconds * 1e6 + 0.5);
+}
 
-bool store_openrocket_to_flash(const char* sd_filename) {
-    printf("Storing '%s' to flash...\n", sd_filename);
+// Builds the profile image a sector at a time, programming each one as it fills
+struct ProfileWriter {
+    uint8_t* buffer;     // STORE_CHUNK_SIZE bytes
+    size_t offset;       // Region offset of buffer[0]
+    size_t used;
+    bool ok;
+};
+
+static void writer_flush(ProfileWriter* writer) {
+    if (!writer->ok || writer->used == 0) {
+        return;
+    }
+    memset(writer->buffer + writer->used, 0xFF, STORE_CHUNK_SIZE - writer->used); // Flash needs 0xFF
+    writer->ok = run_flash_job({(uint32_t)(FLASH_TARGET_OFFSET + writer->offset), writer->buffer, 0,
+                                get_padded_size(writer->used)});
+    writer->offset += STORE_CHUNK_SIZE;
+    writer->used = 0;
+}
+
+static void writer_append(ProfileWriter* writer, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    while (size > 0 && writer->ok) {
+        size_t n = STORE_CHUNK_SIZE - writer->used;
+        if (n > size) n = size;
+        memcpy(writer->buffer + writer->used, bytes, n);
+        writer->used += n;
+        bytes += n;
+        size -= n;
+        if (writer->used == STORE_CHUNK_SIZE) {
+            writer_flush(writer);
+        }
+    }
+}
+
+static bool profile_header_is_valid(const ProfileHeader* header) {
+    if (header->magic != PROFILE_MAGIC || header->version != PROFILE_VERSION
+        || header->header_size != sizeof(ProfileHeader)) {
+        return false;
+    }
+    // Sections must be aligned and inside the region (counts are checked before
+    // multiplying, so a corrupt one can't wrap around)
+    const size_t max_points = FLASH_STORAGE_MAX_SIZE / sizeof(ProfilePoint);
+    const size_t max_flips = FLASH_STORAGE_MAX_SIZE / sizeof(ProfileFlip);
+    return header->point_count > 0 && header->point_count <= max_points && header->flip_count <= max_flips
+        && header->points_offset % 4 == 0 && header->flips_offset % 4 == 0
+        && header->points_offset >= sizeof(ProfileHeader)
+        && header->points_offset + header->point_count * sizeof(ProfilePoint) <= FLASH_STORAGE_MAX_SIZE
+        && header->flips_offset + header->flip_count * sizeof(ProfileFlip) <= FLASH_STORAGE_MAX_SIZE;
+}
+
+// --- Flash Storage Functions ---
 
+bool load_openrocket_from_sd(const char* sd_filename) {
     if (!sd_is_mounted()) { // [cite: uploaded:my_projects/sd_card_manager.cpp]
         printf("Error: SD card not mounted.\n");
         return false;
     }
 
-    // 1. Get file size
     long file_size_long = sd_get_file_size(sd_filename); // [cite: uploaded:my_projects/sd_card_manager.h]
     if (file_size_long < 0) {
         printf("Error: Failed to get size of '%s'\n", sd_filename);
@@ -45,61 +133,129 @@ bool store_openrocket_to_flash(const char* sd_filename) {
     }
     size_t file_size = (size_t)file_size_long;
 
-    // 2. Check if file fits (including our header)
-    size_t total_size_needed = sizeof(FlashDataHeader) + file_size;
-    if (total_size_needed > FLASH_STORAGE_MAX_SIZE) {
-        printf("Error: File size (%u bytes) + header (%u bytes) exceeds flash storage limit (%u bytes).\n",
-               (unsigned int)file_size, (unsigned int)sizeof(FlashDataHeader), (unsigned int)FLASH_STORAGE_MAX_SIZE);
+    char* buffer = (char*)malloc(STORE_CHUNK_SIZE);
+    if (!buffer) {
+        printf("Error: Failed to allocate %u bytes for RAM buffer.\n", (unsigned int)STORE_CHUNK_SIZE);
         return false;
     }
 
-    // 3. Allocate RAM buffer
-    size_t buffer_alloc_size = get_padded_size(total_size_needed);
-    uint8_t* ram_buffer = (uint8_t*)malloc(buffer_alloc_size);
-    if (!ram_buffer) {
-        printf("Error: Failed to allocate %u bytes for RAM buffer.\n", (unsigned int)buffer_alloc_size);
-        return false;
+    // Each read tops the buffer up after the partial line left from the last one
+    printf("Parsing '%s' (%u bytes) from SD...\n", sd_filename, (unsigned int)file_size);
+    parse_openrocket_begin();
+    size_t file_offset = 0;
+    size_t carried = 0;
+    bool read_ok = true;
+    while (file_offset < file_size) {
+        size_t wanted = STORE_CHUNK_SIZE - carried;
+        if (wanted > file_size - file_offset) wanted = file_size - file_offset;
+        int bytes_read = sd_read_file_at(sd_filename, file_offset, buffer + carried, wanted);
+        if (bytes_read < 0 || (size_t)bytes_read != wanted) {
+            printf("Error: Failed to read '%s' at offset %u (%d bytes read).\n", sd_filename, (unsigned int)file_offset, bytes_read);
+            read_ok = false;
+            break;
+        }
+        file_offset += wanted;
+        size_t available = carried + wanted;
+        bool is_last = (file_offset == file_size);
+        size_t used = parse_openrocket_chunk(buffer, available, is_last);
+        if (used == 0 && !is_last) {
+            printf("Error: Line longer than %u bytes at offset %u.\n", (unsigned int)STORE_CHUNK_SIZE, (unsigned int)(file_offset - available));
+            read_ok = false;
+            break;
+        }
+        carried = available - used;
+        memmove(buffer, buffer + used, carried);
     }
-    memset(ram_buffer, 0xFF, buffer_alloc_size); // Flash needs 0xFF
+    free(buffer);
+    bool parsed = parse_openrocket_end();
+    return read_ok && parsed;
+}
 
-    // 4. Read file into RAM buffer (after the header space)
-    int bytes_read = sd_read_file(sd_filename, ram_buffer + sizeof(FlashDataHeader), file_size); // [cite: uploaded:my_projects/sd_card_manager.h]
-    if (bytes_read < 0 || (size_t)bytes_read != file_size) {
-        printf("Error: Failed to read full file '%s' (%d bytes read).\n", sd_filename, bytes_read);
-        free(ram_buffer);
+bool store_profile_to_flash(const char* source_name, float radius_cm) {
+    size_t point_count = get_parsed_data_count();
+    size_t flip_count = flip_schedule_count();
+    if (motor_get_state() != MOTOR_STOPPED) {
+        // Even one sector erase pauses the motor core for tens of milliseconds
+        printf("Error: Stop the motor before storing a profile.\n");
+        return false;
+    }
+    if (point_count == 0) {
+        printf("Error: No parsed data to store.\n");
         return false;
     }
 
-    // 5. Prepare the header
-    FlashDataHeader* header = (FlashDataHeader*)ram_buffer;
-    header->magic = FLASH_DATA_MAGIC;
-    header->data_size = file_size;
-
-    // 6. Flash Operations (Interrupts Disabled)
-    printf("Preparing to write %u bytes (padded) to flash offset 0x%X...\n", (unsigned int)buffer_alloc_size, FLASH_TARGET_OFFSET);
-
-    uint32_t ints = save_and_disable_interrupts();
-
-    // Erase necessary sectors
-    size_t erase_size = get_padded_size(total_size_needed);
-    printf("Erasing %u bytes...\n", (unsigned int)erase_size);
-    flash_range_erase(FLASH_TARGET_OFFSET, erase_size);
-
-    // Program the data
-    printf("Programming %u bytes...\n", (unsigned int)buffer_alloc_size);
-    flash_range_program(FLASH_TARGET_OFFSET, ram_buffer, buffer_alloc_size);
+    // 1. Lay out the image and check it fits
+    ProfileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = 0xFFFFFFFFu; // Left erased until everything else is written
+    header.version = PROFILE_VERSION;
+    header.header_size = sizeof(ProfileHeader);
+    header.point_count = (uint32_t)point_count;
+    header.points_offset = sizeof(ProfileHeader);
+    header.flip_count = (uint32_t)flip_count;
+    header.flips_offset = (uint32_t)(header.points_offset + point_count * sizeof(ProfilePoint));
+    header.radius_cm = radius_cm;
+    strncpy(header.source_name, source_name, sizeof(header.source_name) - 1);
+
+    size_t total_size = header.flips_offset + flip_count * sizeof(ProfileFlip);
+    if (total_size > FLASH_STORAGE_MAX_SIZE) {
+        printf("Error: Profile (%u points, %u flips, %u bytes) exceeds flash storage limit (%u bytes, about %u points).\n",
+               (unsigned int)point_count, (unsigned int)flip_count, (unsigned int)total_size,
+               (unsigned int)FLASH_STORAGE_MAX_SIZE,
+               (unsigned int)((FLASH_STORAGE_MAX_SIZE - sizeof(ProfileHeader)) / sizeof(ProfilePoint)));
+        return false;
+    }
+    FlightDataPoint last = get_parsed_data_point(point_count - 1);
+    if (last.timestamp > MAX_PROFILE_TIME_S) {
+        printf("Error: Profile runs %.0f s; at most %.0f s can be stored.\n", last.timestamp, MAX_PROFILE_TIME_S);
+        return false;
+    }
+    header.duration_us = seconds_to_us(last.timestamp);
 
-    restore_interrupts(ints);
+    uint8_t* ram_buffer = (uint8_t*)malloc(STORE_CHUNK_SIZE);
+    if (!ram_buffer) {
+        printf("Error: Failed to allocate %u bytes for RAM buffer.\n", (unsigned int)STORE_CHUNK_SIZE);
+        return false;
+    }
 
-    // 7. Verification (Optional but Recommended)
-    const FlashDataHeader* readback_header = (const FlashDataHeader*)FLASH_STORAGE_ADDRESS;
-    bool verified = (memcmp(header, readback_header, sizeof(FlashDataHeader)) == 0);
-    // Could add full data verification here if needed
+    // 2. Erase the sectors the image needs, one per job (other core locked out, interrupts disabled)
+    size_t erase_size = (total_size + FLASH_SECTOR_SIZE - 1) & ~(size_t)(FLASH_SECTOR_SIZE - 1);
+    printf("Writing profile: %u points, %u flips, %u bytes at flash offset 0x%X...\n",
+           (unsigned int)point_count, (unsigned int)flip_count, (unsigned int)total_size, FLASH_TARGET_OFFSET);
+    for (size_t erased = 0; erased < erase_size; erased += FLASH_SECTOR_SIZE) {
+        if (!run_flash_job({(uint32_t)(FLASH_TARGET_OFFSET + erased), nullptr, FLASH_SECTOR_SIZE, 0})) {
+            free(ram_buffer);
+            return false;
+        }
+    }
 
-    // 8. Cleanup
+    // 3. Header (without its magic), points, flips
+    ProfileWriter writer = {ram_buffer, 0, 0, true};
+    writer_append(&writer, &header, sizeof(header));
+    for (size_t i = 0; i < point_count && writer.ok; ++i) {
+        FlightDataPoint point = get_parsed_data_point(i);
+        ProfilePoint stored = {seconds_to_us(point.timestamp), point.target_pps};
+        writer_append(&writer, &stored, sizeof(stored));
+    }
+    for (size_t i = 0; i < flip_count && writer.ok; ++i) {
+        ServoFlip flip = flip_schedule_get(i);
+        ProfileFlip stored = {seconds_to_us(flip.crossing_s), flip.position};
+        writer_append(&writer, &stored, sizeof(stored));
+    }
+    writer_flush(&writer);
+
+    // 4. Validate the image: program the magic over its erased word
+    bool written = writer.ok;
+    if (written) {
+        memset(ram_buffer, 0xFF, FLASH_PAGE_SIZE);
+        ((ProfileHeader*)ram_buffer)->magic = PROFILE_MAGIC;
+        written = run_flash_job({FLASH_TARGET_OFFSET, ram_buffer, 0, FLASH_PAGE_SIZE});
+    }
     free(ram_buffer);
 
-    if (verified) {
+    // 5. Verification
+    const ProfileHeader* stored_header = get_profile_header();
+    if (written && stored_header && stored_header->point_count == point_count && stored_header->flip_count == flip_count) {
         printf("Flash write successful and verified.\n");
         return true;
     } else {
@@ -108,193 +264,23 @@ bool store_openrocket_to_flash(const char* sd_filename) {
     }
 }
 
-int read_openrocket_from_flash(void* buffer, size_t buffer_size) {
-    const FlashDataHeader* header = (const FlashDataHeader*)FLASH_STORAGE_ADDRESS;
-
-    // 1. Check magic number
-    if (header->magic != FLASH_DATA_MAGIC) {
-        printf("Error: Flash data magic number mismatch.\n");
-        return -1;
-    }
-
-    // 2. Get stored data size
-    size_t stored_size = header->data_size;
-     if (stored_size == 0 || stored_size > (FLASH_STORAGE_MAX_SIZE - sizeof(FlashDataHeader))) {
-        printf("Error: Invalid stored data size (%u bytes) in flash header.\n", (unsigned int)stored_size);
-         return -1;
-    }
-
-
-    // 3. Check if user buffer is large enough
-    if (stored_size > buffer_size) {
-        printf("Error: Provided buffer (%u bytes) is too small for stored data (%u bytes).\n", (unsigned int)buffer_size, (unsigned int)stored_size);
-        return -1;
-    }
-
-    // 4. Copy data from flash (after the header) to the user buffer
-    const uint8_t* flash_data_start = (const uint8_t*)FLASH_STORAGE_ADDRESS + sizeof(FlashDataHeader);
-    memcpy(buffer, flash_data_start, stored_size);
-
-    printf("Read %u bytes from flash.\n", (unsigned int)stored_size);
-    return (int)stored_size;
-}
-
-size_t get_stored_data_size_from_flash() {
-     const FlashDataHeader* header = (const FlashDataHeader*)FLASH_STORAGE_ADDRESS;
-     if (header->magic == FLASH_DATA_MAGIC) {
-         if (header->data_size < (FLASH_STORAGE_MAX_SIZE - sizeof(FlashDataHeader))) {
-            return header->data_size;
-         }
-     }
-     return 0; // Indicate no valid data or header found
+const ProfileHeader* get_profile_header() {
+    const ProfileHeader* header = (const ProfileHeader*)FLASH_STORAGE_ADDRESS;
+    return profile_header_is_valid(header) ? header : nullptr;
 }
 
-
-// --- CSV Parsing Function (Corrected Logic) ---
-
-bool parse_openrocket_data(const char* data_buffer, size_t data_size) {
-    printf("Parsing flight data (%u bytes)...\n", (unsigned int)data_size);
-    parsed_flight_data.clear();
-
-    bool found_ignition = false;
-    bool found_apogee = false;
-
-    char* buffer_copy = (char*)malloc(data_size + 1);
-    if (!buffer_copy) {
-        printf("Error: Failed to allocate buffer for parsing.\n");
-        return false;
+const ProfilePoint* get_profile_points() {
+    const ProfileHeader* header = get_profile_header();
+    if (!header) {
+        return nullptr;
     }
-    memcpy(buffer_copy, data_buffer, data_size);
-    buffer_copy[data_size] = '\0';
-
-    char* saveptr;
-    char* line = strtok_r(buffer_copy, "\n\r", &saveptr);
-
-    while (line != nullptr && !found_apogee) {
-        // --- Logic for finding the start ---
-        if (!found_ignition) {
-            if (strstr(line, "# Event IGNITION") != nullptr) {
-                printf("Found IGNITION event.\n");
-                found_ignition = true;
-                // Continue to the next line immediately
-                line = strtok_r(nullptr, "\n\r", &saveptr);
-                continue;
-            }
-            // Skip lines before IGNITION is found
-            line = strtok_r(nullptr, "\n\r", &saveptr);
-            continue;
-        }
-
-        // --- Logic after IGNITION is found ---
-
-        // Check for APOGEE first (stops parsing)
-        if (strstr(line, "# Event APOGEE") != nullptr) {
-            printf("Found APOGEE event. Stopping parse.\n");
-            found_apogee = true;
-            break; // Exit the while loop
-        }
-
-        // Check if the line starts with *any* "# Event" and skip it
-        if (strstr(line, "# Event") == line) { // Check prefix
-             printf("Skipping event line: %s\n", line);
-             line = strtok_r(nullptr, "\n\r", &saveptr);
-             continue; // Skip to next line
-        }
-
-        // Attempt to parse as data
-        float timestamp = 0.0f;
-        float acceleration = 0.0f;
-        // Use sscanf. Add error checking as needed.
-        if (sscanf(line, "%f,%f", &timestamp, &acceleration) == 2) {
-            parsed_flight_data.push_back({timestamp, acceleration});
-        } else {
-            if (strlen(line) > 0) { // Avoid warning on blank lines
-                 printf("Warning: Failed to parse data line: %s\n", line);
-            }
-        }
-
-        // Get the next line
-        line = strtok_r(nullptr, "\n\r", &saveptr);
-    } // End while loop
-    
-
-    free(buffer_copy);
-
-    printf("Parsing finished. Found %u data points.\n", (unsigned int)parsed_flight_data.size());
-    return found_ignition; // Success if we at least found ignition
+    return (const ProfilePoint*)(FLASH_STORAGE_ADDRESS + header->points_offset);
 }
 
-
-// --- Accessor Functions for Parsed Data ---
-
-size_t get_parsed_data_count() {
-    return parsed_flight_data.size();
-}
-
-FlightDataPoint get_parsed_data_point(size_t index) {
-    if (index < parsed_flight_data.size()) {
-        return parsed_flight_data[index];
+const ProfileFlip* get_profile_flips() {
+    const ProfileHeader* header = get_profile_header();
+    if (!header) {
+        return nullptr;
     }
-    // Return a default/invalid point if index is out of bounds
-    printf("Warning: Requested parsed data index %u out of bounds (size %u).\n",
-           (unsigned int)index, (unsigned int)parsed_flight_data.size());
-    return {0.0f, 0.0f};
+    return (const ProfileFlip*)(FLASH_STORAGE_ADDRESS + header->flips_offset);
 }
-
-bool calculate_pps_for_parsed_data(float radius_m) {
-    const float G_ACCEL = 9.80665f; // m/s^2
-    const float RPM_TO_PPS_FACTOR = 0.3f; // From user: RPM = PPS * 0.3 => PPS = RPM / 0.3
-
-    if (radius_m <= 0.0f) {
-        printf("Error: Invalid radius (%.3f m) for PPS calculation.\n", radius_m);
-        return false;
-    }
-    if (parsed_flight_data.empty()) {
-        printf("Warning: No parsed data available to calculate PPS.\n");
-        return false;
-    }
-
-    printf("Calculating Target PPS for %u points with radius %.3f m (Map Gs->RPM->PPS)...\n", // Updated message
-           (unsigned int)parsed_flight_data.size(), radius_m);
-
-    for (FlightDataPoint& point : parsed_flight_data) { // Use reference to modify
-        float target_rpm = 0.0f;
-        float target_pps = 0.0f;
-
-        // Step 1: Calculate target physical angular velocity (omega) in rad/s from Gs
-        float accel_g_abs = fabsf(point.acceleration);
-        float accel_mps2 = accel_g_abs * G_ACCEL;
-        float omega_squared = 0.0f;
-        if (radius_m > 0.0f && accel_mps2 > 0.0f) {
-             omega_squared = accel_mps2 / radius_m;
-        }
-        float omega = 0.0f; // rad/s
-        if (omega_squared > 0.0f) {
-             omega = sqrt(omega_squared);
-        }
-
-        // Step 2: Convert omega (rad/s) to target physical RPM
-        if (omega > 0.0f) {
-            // omega (rad/s) * (60 s / min) / (2*pi rad / rev) = RPM
-            target_rpm = omega * 60.0f / (2.0f * M_PI);
-        } else {
-            target_rpm = 0.0f;
-        }
-
-        // Step 3: Convert target physical RPM to required input PPS using the provided factor
-        if (target_rpm > 0.0f && RPM_TO_PPS_FACTOR != 0.0f) {
-             target_pps = target_rpm / RPM_TO_PPS_FACTOR;
-        } else {
-             target_pps = 0.0f;
-        }
-
-        // Store the final calculated PPS value needed by the motor driver
-        point.target_pps = target_pps;
-
-        // Optional: Print intermediate and final values during debug
-        // printf("  t=%.3f, G=%.3f -> omega=%.3f rad/s -> RPM=%.3f -> PPS=%.3f Hz\n",
-        //        point.timestamp, point.acceleration, omega, target_rpm, point.target_pps);
-    }
-    printf("PPS calculation complete.\n");
-    return true;
-}
\ No newline at end of file
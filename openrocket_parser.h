@@ -4,6 +4,7 @@
 #include <cstddef> // For size_t
 #include <cstdint> // For uint types like uint32_t
 #include "pico/stdlib.h" // Includes basic types and potentially XIP_BASE, PICO_FLASH_SIZE_BYTES
+#include "openrocket_csv.h" // Parsing of the CSV the profile is compiled from
 
 // --- Configuration: Flash Storage ---
 
@@ -18,75 +19,75 @@
 #define FLASH_TARGET_OFFSET    (PICO_FLASH_SIZE_BYTES - FLASH_STORAGE_MAX_SIZE)
 #define FLASH_STORAGE_ADDRESS  (XIP_BASE + FLASH_TARGET_OFFSET)
 
-// Header stored at the beginning of the flash region
-struct FlashDataHeader {
-    uint32_t magic;      // To verify data presence/version
-    uint32_t data_size;  // Actual size of the stored OpenRocket data in bytes
+// --- Binary Profile Format ---
+// The region holds a compiled profile: the header, the points, then the servo
+// flips, all word aligned and read in place through XIP. A profile is about
+// 8 bytes per point against 15-20 for the CSV line it came from (much more for
+// multi-column exports), and needs no parsing after a reboot.
+#define PROFILE_MAGIC   0x464F5250u // "PROF"
+#define PROFILE_VERSION 1           // Bump on any layout change; other versions are not read
+
+struct ProfileHeader {
+    uint32_t magic;          // PROFILE_MAGIC, programmed last so a cut-off write is never taken as valid
+    uint16_t version;        // PROFILE_VERSION
+    uint16_t header_size;    // sizeof(ProfileHeader)
+    uint32_t point_count;
+    uint32_t points_offset;  // Bytes from the start of the region
+    uint32_t flip_count;
+    uint32_t flips_offset;   // Bytes from the start of the region
+    uint32_t duration_us;    // Time of the last point
+    float radius_cm;         // Radius the PPS values were computed for
+    char source_name[32];    // The CSV it was compiled from (NUL-terminated, may be cut short)
 };
-#define FLASH_DATA_MAGIC 0xFDEDBEEF // Example magic number ("FEED BEEF" sort of)
+static_assert(sizeof(ProfileHeader) == 64, "Header layout is part of the flash format");
 
-// --- Data Structure for Parsed Flight Data ---
-struct FlightDataPoint {
-    float timestamp;
-    float acceleration; // Original G value
-    float target_pps;   // Calculated Pulses Per Second (Hz) for motor
+struct ProfilePoint {
+    uint32_t time_us;        // From ignition
+    float target_pps;        // Step rate for the configured radius
+};
+
+struct ProfileFlip {
+    uint32_t crossing_us;    // Profile time of the G zero crossing
+    float position;          // Servo position from then on (0.0 or 1.0)
 };
 
 // --- Function Declarations: Flash Handling ---
 
 /**
- * @brief Reads an OpenRocket file from the SD card and writes it to the defined flash region.
+ * @brief Parses an OpenRocket CSV straight from the SD card (see openrocket_csv.h)
+ * into the parsed data, reading it through one sector-sized buffer, so neither
+ * the file size nor the flash region limits it.
  * @param sd_filename The full path to the file on the SD card.
- * @return True on success, false on failure.
- */
-bool store_openrocket_to_flash(const char* sd_filename);
-
-/**
- * @brief Reads the previously stored OpenRocket data from flash into a RAM buffer.
- * @param buffer Pointer to the RAM buffer where data will be copied.
- * @param buffer_size The maximum size of the provided RAM buffer.
- * @return The number of bytes read (actual data size), or -1 on error.
+ * @return True if the parse succeeded (see parse_openrocket_data).
  */
-int read_openrocket_from_flash(void* buffer, size_t buffer_size);
+bool load_openrocket_from_sd(const char* sd_filename);
 
 /**
- * @brief Gets the size of the data currently stored in flash, based on the header.
- * @return The size of the stored data in bytes, or 0 if no valid header is found.
+ * @brief Compiles the parsed data (with its PPS calculated) and the flip schedule
+ * into a binary profile and writes it to the flash region, replacing the one there.
+ * @param source_name Name of the CSV, kept in the header for display.
+ * @param radius_cm Radius the PPS values were calculated for.
+ * Refused unless the motor is stopped: the writes pause the motor core.
+ * @return True on success, false on failure (motor running, too big, or a flash error).
  */
-size_t get_stored_data_size_from_flash();
-
-// --- Function Declarations: CSV Parsing ---
-
-/**
- * @brief Parses the flight data buffer (read from flash).
- * Stores valid timestamp,acceleration pairs between "# Event IGNITION" and "# Event APOGEE".
- * @param data_buffer Pointer to the character buffer holding the CSV data.
- * @param data_size The size of the data in the buffer.
- * @return True if parsing finished successfully (IGNITION found), false otherwise.
- */
-bool parse_openrocket_data(const char* data_buffer, size_t data_size);
-
-// --- Function Declarations: Accessors for Parsed Data ---
+bool store_profile_to_flash(const char* source_name, float radius_cm);
 
 /**
- * @brief Gets the number of valid data points parsed.
- * @return The count of stored FlightDataPoints.
+ * @brief Gets the header of the profile in flash, after checking it.
+ * @return Pointer into XIP flash, or nullptr if no valid profile is stored.
  */
-size_t get_parsed_data_count();
+const ProfileHeader* get_profile_header();
 
 /**
- * @brief Gets a specific parsed data point by index.
- * @param index The index of the data point (0 to count-1).
- * @return The FlightDataPoint at the specified index. Returns {0, 0} if index is out of bounds.
+ * @brief Gets the stored points where they sit in XIP flash (get_profile_header()->point_count of them).
+ * @return Pointer into flash, or nullptr if no valid profile is stored.
  */
-FlightDataPoint get_parsed_data_point(size_t index);
+const ProfilePoint* get_profile_points();
 
 /**
- * @brief Calculates target PPS for all previously parsed data points based on radius.
- * Populates the target_pps field in the stored FlightDataPoints.
- * @param radius_m The radius of the centrifuge arm in meters.
- * @return True on success, false if no data was parsed or radius is invalid.
+ * @brief Gets the stored servo flips in time order (get_profile_header()->flip_count of them).
+ * @return Pointer into flash, or nullptr if no valid profile is stored.
  */
-bool calculate_pps_for_parsed_data(float radius_m);
+const ProfileFlip* get_profile_flips();
 
 #endif // OPENROCKET_PARSER_H
\ No newline at end of file
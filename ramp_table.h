@@ -0,0 +1,156 @@
+#ifndef RAMP_TABLE_H
+#define RAMP_TABLE_H
+
+/**
+ * @file ramp_table.h
+ * @brief Step interval tables for fixed ramps, generated at compile time.
+ *
+ * A ramp whose parameters are all compile-time constants (the 't' test run, or a
+ * pre-spin to a fixed speed such as 1 G at a fixed radius) produces the same step
+ * intervals every time. ramp_table_build() runs the planner's per-step S-curve
+ * (planner_next_interval, without resonance bands) in a constexpr context, along
+ * with the microstep mode of every pulse, so the step path only reads the next
+ * entry: no square roots or divisions while it plays.
+ *
+ * The S-curve closes on the target slowly, so the table stops once the speed is
+ * within RAMP_TABLE_SETTLE_FRACTION of it and records the state it ends in; the
+ * planner, set to that state, settles the rest with the same arithmetic.
+ *
+ *     constexpr RampSpec SPEC = {...};
+ *     constexpr RampTable<ramp_table_length(SPEC)> TABLE = ramp_table_build<ramp_table_length(SPEC)>(SPEC);
+ *
+ * A table costs 5 bytes per STEP pulse, so a ramp at 1/16 step quickly runs to tens
+ * of kilobytes of flash. A length of 0 builds an empty table, for an axis that
+ * keeps none. Pure C++17 with no SDK dependencies.
+ */
+
+#include "microstep.h"
+#include <cstddef>
+#include <cstdint>
+
+// --- Public Configuration ---
+
+// Upper bound on a table, so a bad spec fails to compile instead of looping
+constexpr size_t RAMP_TABLE_MAX_STEPS = 65536;
+
+// The table ends once the speed is this close to the target (fraction of it)
+constexpr float RAMP_TABLE_SETTLE_FRACTION = 0.01f;
+
+// --- Public Types ---
+
+// A ramp from start_pps up to target_pps. Speeds are in full steps per second.
+struct RampSpec {
+    float start_pps;            // Speed of the first step (the pull-in rate)
+    float target_pps;           // Speed the ramp settles at, > start_pps
+    float max_accel;            // PPS per second
+    float max_jerk;             // PPS per second^2
+    const MicrostepMode* modes; // Driver modes, finest first (as in the axis Config)
+    size_t mode_count;
+    float max_pulse_pps;        // STEP pulse rate limit for the mode selection
+};
+
+// One entry per STEP pulse, then the planner state to hand over with
+template <size_t N>
+struct RampTable {
+    float interval_s[N]; // From this pulse to the next
+    uint8_t mode[N];     // Microstep mode this pulse is played in
+    float end_speed;     // Speed after the last pulse, within the settle fraction of target_pps
+    float end_accel;     // Acceleration after the last pulse
+};
+
+// No table
+template <>
+struct RampTable<0> {};
+
+// --- Compile-Time Generator ---
+
+// Same arithmetic as planner_next_interval, step by step
+struct RampGenerator {
+    RampSpec spec;
+    float speed;   // Speed after the step last generated
+    float accel;
+    size_t mode;
+
+    // Newton's method; speeds only change a little per step, so start from the last one
+    static constexpr float sqrt_near(float x, float guess) {
+        if (x <= 0.0f) return 0.0f;
+        float r = (guess > 0.0f) ? guess : x;
+        for (int i = 0; i < 32; ++i) {
+            float next = 0.5f * (r + x / r);
+            if (next == r) break;
+            r = next;
+        }
+        return r;
+    }
+
+    constexpr explicit RampGenerator(const RampSpec& s)
+        : spec(s), speed(s.start_pps), accel(0.0f),
+          mode(microstep_select(s.modes, s.mode_count, 0, s.start_pps, s.max_pulse_pps)) {}
+
+    constexpr bool done() const { return spec.target_pps - speed <= spec.target_pps * RAMP_TABLE_SETTLE_FRACTION; }
+
+    // Generates one pulse; returns its interval and leaves the mode for the next pulse in `mode`
+    constexpr float next() {
+        float d = 1.0f / spec.modes[mode].microsteps;
+        float v = speed;
+        float dv = spec.target_pps - v;
+
+        float accel_wanted = sqrt_near(2.0f * spec.max_jerk * dv, accel);
+        if (accel_wanted > spec.max_accel) accel_wanted = spec.max_accel;
+        float max_change = spec.max_jerk * d / v;
+        if (accel_wanted > accel + max_change) {
+            accel += max_change;
+        } else if (accel_wanted < accel - max_change) {
+            accel -= max_change;
+        } else {
+            accel = accel_wanted;
+        }
+
+        float v_next = sqrt_near(v * v + 2.0f * accel * d, v);
+        if (v_next >= spec.target_pps) {
+            v_next = spec.target_pps;
+            accel = 0.0f;
+        }
+        speed = v_next;
+        if (spec.mode_count > 1) {
+            mode = microstep_select(spec.modes, spec.mode_count, mode, v_next, spec.max_pulse_pps);
+        }
+        return 2.0f * d / (v + v_next);
+    }
+};
+
+// --- Public Functions ---
+
+/**
+ * @brief Number of STEP pulses in the ramp (the table size to build).
+ */
+constexpr size_t ramp_table_length(const RampSpec& spec) {
+    RampGenerator gen(spec);
+    size_t n = 0;
+    while (!gen.done() && n < RAMP_TABLE_MAX_STEPS) {
+        gen.next();
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * @brief Builds the table; N must be ramp_table_length(spec), or 0 for no table.
+ */
+template <size_t N>
+constexpr RampTable<N> ramp_table_build(const RampSpec& spec) {
+    static_assert(N < RAMP_TABLE_MAX_STEPS, "Ramp is too long for a table");
+    RampTable<N> table = {};
+    if constexpr (N > 0) {
+        RampGenerator gen(spec);
+        for (size_t i = 0; i < N; ++i) {
+            table.mode[i] = (uint8_t)gen.mode;
+            table.interval_s[i] = gen.next();
+        }
+        table.end_speed = gen.speed;
+        table.end_accel = gen.accel;
+    }
+    return table;
+}
+
+#endif // RAMP_TABLE_H
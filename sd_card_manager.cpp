@@ -148,6 +148,33 @@ int sd_read_file(const char* filename, void* buffer, size_t max_size) {
 }
 
 
+int sd_read_file_at(const char* filename, size_t offset, void* buffer, size_t size) {
+    if (!is_mounted) {
+        printf("ERROR: SD card not mounted.\n");
+        return -1;
+    }
+
+    FIL fil;
+    FRESULT fr;
+    UINT bytes_read = 0;
+
+    fr = f_open(&fil, filename, FA_READ);
+    if (fr != FR_OK) {
+        printf("ERROR: Failed to open file '%s' for reading (%d)\n", filename, fr);
+        return -1;
+    }
+
+    fr = f_lseek(&fil, (FSIZE_t)offset);
+    if (fr == FR_OK) {
+        fr = f_read(&fil, buffer, size, &bytes_read);
+    }
+    f_close(&fil);
+    if (fr != FR_OK) {
+        printf("ERROR: Failed to read '%s' at offset %u (%d)\n", filename, (unsigned int)offset, fr);
+        return -1;
+    }
+    return (int)bytes_read;
+}
 long sd_get_file_size(const char* filename) {
      if (!is_mounted) {
         printf("ERROR: SD card not mounted.\n");
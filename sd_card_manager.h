@@ -23,6 +23,11 @@ bool sd_write_file(const char* filename, const void* data, size_t size);
 // Returns the number of bytes read, or -1 on error.
 int sd_read_file(const char* filename, void* buffer, size_t max_size);
 
+// Read part of a file: up to 'size' bytes starting at byte 'offset'.
+// Lets large files be processed in fixed-size chunks.
+// Returns the number of bytes read (0 at or past the end), or -1 on error.
+int sd_read_file_at(const char* filename, size_t offset, void* buffer, size_t size);
+
 // Get the size of a file.
 // Returns the file size in bytes, or -1 if the file doesn't exist or an error occurs.
 long sd_get_file_size(const char* filename);
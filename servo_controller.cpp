@@ -1,7 +1,14 @@
 #include "servo_controller.h"
+#include "servo_motion.h"
+#include "servo_feedback.h"
+#include "config_store.h"
 #include "hardware/pwm.h"
 #include "hardware/gpio.h"
 #include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
 #include "pico/time.h"
 #include <cmath>
 #include <cstdio>
@@ -12,29 +19,151 @@
 #include <cctype>   // Needed for isdigit, isprint in input reading
 
 // --- Constants ---
-const float PWM_FREQUENCY = 50.0f; // Hz (20ms period) [cite: uploaded:my_projects/servo_controller.cpp]
+const float DEFAULT_SERVO_FRAME_RATE_HZ = 50.0f; // Hz (20ms period), safe for analog servos [cite: uploaded:my_projects/servo_controller.cpp]
+const uint32_t PWM_MAX_WRAP = 65535;          // 16-bit counter
+const uint32_t FEEDBACK_REST_MS = 1000;       // Settling time before a feedback reading at rest
+const uint32_t FEEDBACK_RING_BITS = 7;        // log2 of the ring size in bytes (DMA address wrap)
+const float FRAME_RATE_CHANGE_GUARD_US = 20.0f; // Margin after the pulse and before the wrap for a rate change
+const ServoMotionLimits DEFAULT_SERVO_MOTION_LIMITS = {0.0f, 0.0f}; // Unlimited: the servo's own slew applies
+const float DEFAULT_SERVO_TRAVEL_TIME_S = 0.25f; // Hobby servo: about 120 degrees at 0.12 s per 60
 
 // --- Internal Variables ---
 static uint s_pwm_slice_num;
 static pwm_config s_pwm_config;
 static uint32_t s_pwm_wrap_value;
+static bool s_pwm_running = false;
+static float s_frame_rate_hz = DEFAULT_SERVO_FRAME_RATE_HZ; // Requested; the effective rate is 1 / s_frame_period_s
+static float s_counts_per_us = 1.0f;                         // PWM counter ticks per microsecond of pulse
+
+// Position -> PWM level mapping, rebuilt whenever the calibration or the PWM timing
+// changes: level = (base + span * position) >> 16, all Q16 (position 1.0 = 65536)
+static uint32_t s_level_base_q16 = 0;
+static uint32_t s_level_span_q16 = 0;
 
 // Current servo pulse settings (microseconds) - Initialized with typical values
 static float s_min_pulse_us = 600.0f;  // Default min [cite: uploaded:my_projects/servo_controller.cpp]
 static float s_max_pulse_us = 2400.0f; // Default max [cite: uploaded:my_projects/servo_controller.cpp]
 
+// Motion engine, advanced by the PWM wrap interrupt once per frame
+static ServoMotion s_motion;
+static float s_frame_period_s = 1.0f / DEFAULT_SERVO_FRAME_RATE_HZ;
+static volatile bool s_motion_complete = true;
+static ServoMotionCallback s_motion_callback = nullptr;
+static void* s_motion_callback_context = nullptr;
+static float s_travel_time_s = DEFAULT_SERVO_TRAVEL_TIME_S; // Flip lead for the simulation
+
+// Feedback pot: the ADC free-runs into this ring through DMA. The write address
+// wraps on the ring size, so the buffer is aligned to it.
+static_assert((1u << FEEDBACK_RING_BITS) == SERVO_FEEDBACK_AVERAGE * sizeof(uint16_t), "Ring size mismatch");
+static uint16_t s_feedback_ring[SERVO_FEEDBACK_AVERAGE] __attribute__((aligned(1u << FEEDBACK_RING_BITS)));
+static int s_feedback_dma_channel = -1;
+static ServoFeedbackCal s_feedback_cal = {0.0f, 0.0f};
+
 // --- Helper Functions ---
 
-// Calculates the PWM level (duty cycle count) for a given pulse width in microseconds
-static uint16_t calculate_pwm_level(float pulse_us) { // [cite: uploaded:my_projects/servo_controller.cpp]
-    // Clamp pulse width to prevent going beyond theoretical limits if desired
-    // (e.g., pulse_us = std::max(400.0f, std::min(2600.0f, pulse_us)); )
+// Finest divider (the hardware has 1/16 steps) that still fits one frame in the
+// 16-bit counter, and the wrap for it
+static void compute_pwm_timing(float frame_rate_hz, float* divider, uint32_t* wrap) {
+    uint32_t sys_clk_hz = clock_get_hz(clk_sys);
+    float counts_per_frame = (float)sys_clk_hz / frame_rate_hz;
+    float div = ceilf(counts_per_frame * 16.0f / (float)(PWM_MAX_WRAP + 1)) / 16.0f;
+    if (div < 1.0f) div = 1.0f;
+    if (div >= 256.0f) div = 255.0f + 15.0f / 16.0f;
+    uint32_t top = static_cast<uint32_t>(roundf(counts_per_frame / div)) - 1;
+    if (top > PWM_MAX_WRAP) top = PWM_MAX_WRAP;
+    *divider = div;
+    *wrap = top;
+}
 
-    float duty_cycle = pulse_us / (1000000.0f / PWM_FREQUENCY); // fraction of the period [cite: uploaded:my_projects/servo_controller.cpp]
-    uint16_t level = static_cast<uint16_t>(roundf(duty_cycle * (s_pwm_wrap_value + 1))); // [cite: uploaded:my_projects/servo_controller.cpp]
-    // Clamp level just in case
-    if (level > s_pwm_wrap_value) level = s_pwm_wrap_value; // [cite: uploaded:my_projects/servo_controller.cpp]
-    return level;
+// Updates the state derived from the divider and wrap the slice now runs with
+static void record_pwm_timing(float divider, uint32_t wrap) {
+    float sys_clk_hz = (float)clock_get_hz(clk_sys);
+    s_pwm_wrap_value = wrap;
+    s_counts_per_us = sys_clk_hz / (divider * 1000000.0f);
+    s_frame_period_s = divider * (float)(wrap + 1) / sys_clk_hz;
+}
+
+// A pulse has to end a guard before the frame does: the change of frame rate needs
+// that low part, and it keeps the level inside the wrap
+static bool pulse_fits_frame(float pulse_us, float frame_period_us) {
+    return pulse_us >= 0.0f && pulse_us + 2.0f * FRAME_RATE_CHANGE_GUARD_US <= frame_period_us;
+}
+
+// Frame period in force (or the one servo_init() will start with)
+static float current_frame_period_us() {
+    return s_pwm_running ? s_frame_period_s * 1000000.0f : 1000000.0f / s_frame_rate_hz;
+}
+
+// Recomputes the position -> level mapping from the pulse widths and the PWM timing.
+// All the float work happens here, once per calibration or timing change; the
+// pair is swapped with IRQs off so the frame interrupt never sees half of it.
+static void rebuild_level_map() {
+    // The setters keep the pulses inside the frame; the clamp only keeps the casts
+    // defined and base + span from wrapping (the level is clamped to the wrap anyway)
+    const float limit_q16 = (float)s_pwm_wrap_value * 65536.0f;
+    float base_q16 = s_min_pulse_us * s_counts_per_us * 65536.0f;
+    float span_q16 = (s_max_pulse_us - s_min_pulse_us) * s_counts_per_us * 65536.0f;
+    if (!(base_q16 > 0.0f)) base_q16 = 0.0f;
+    if (base_q16 > limit_q16) base_q16 = limit_q16;
+    if (!(span_q16 > 0.0f)) span_q16 = 0.0f;
+    if (span_q16 > limit_q16 - base_q16) span_q16 = limit_q16 - base_q16;
+    uint32_t ints = save_and_disable_interrupts();
+    s_level_base_q16 = (uint32_t)base_q16;
+    s_level_span_q16 = (uint32_t)span_q16;
+    restore_interrupts(ints);
+}
+
+static uint32_t position_to_q16(float position) {
+    return (uint32_t)(position * (float)SERVO_POSITION_ONE_Q16 + 0.5f);
+}
+
+// After a calibration change: a servo at rest gets no frame updates, so set it here
+static void refresh_level() {
+    if (servo_motion_is_complete(&s_motion)) {
+        pwm_set_gpio_level(SERVO_PIN, servo_level_for_position_q16(position_to_q16(s_motion.position)));
+    }
+}
+
+// Starts the ADC free-running on the feedback pin, with a DMA channel that never
+// finishes (endless transfer count) copying each sample into the ring
+static void feedback_init() {
+    adc_init();
+    adc_gpio_init(SERVO_FEEDBACK_ADC_PIN);
+    adc_select_input(SERVO_FEEDBACK_ADC_PIN - ADC_BASE_PIN);
+    adc_fifo_setup(true, true, 1, false, false); // FIFO on, DREQ per sample, 12-bit samples
+    adc_set_clkdiv(48000000.0f / SERVO_FEEDBACK_SAMPLE_HZ - 1.0f); // 48 MHz ADC clock
+
+    s_feedback_dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(s_feedback_dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, FEEDBACK_RING_BITS);
+    channel_config_set_dreq(&config, DREQ_ADC);
+    dma_channel_configure(s_feedback_dma_channel, &config, s_feedback_ring, &adc_hw->fifo,
+                          dma_encode_endless_transfer_count(), true);
+    adc_run(true);
+    printf("  Servo feedback: ADC on GPIO %d, %lu samples/s, %u-sample average\n",
+           SERVO_FEEDBACK_ADC_PIN, (unsigned long)SERVO_FEEDBACK_SAMPLE_HZ, (unsigned)SERVO_FEEDBACK_AVERAGE);
+}
+
+// PWM wrap: one call per frame, at the frame boundary. The level written here is
+// latched by the slice at the next wrap, so every frame carries one whole pulse.
+static void servo_frame_irq_handler() {
+    if (!(pwm_get_irq_status_mask() & (1u << s_pwm_slice_num))) return; // Another slice
+    pwm_clear_irq(s_pwm_slice_num);
+    if (servo_motion_is_complete(&s_motion)) {
+        return; // At rest: the slice keeps repeating the last level
+    }
+
+    bool completed = servo_motion_step(&s_motion, s_frame_period_s);
+    pwm_set_gpio_level(SERVO_PIN, servo_level_for_position_q16(position_to_q16(s_motion.position)));
+    if (completed) {
+        s_motion_complete = true;
+        if (s_motion_callback) {
+            s_motion_callback(s_motion.position, s_motion_callback_context);
+        }
+    }
 }
 
 // Helper to read a float from serial (adapted from SerialMenu.cpp)
@@ -88,26 +217,46 @@ void servo_init() {
     s_pwm_slice_num = pwm_gpio_to_slice_num(SERVO_PIN); // [cite: uploaded:my_projects/servo_controller.cpp]
 
     uint32_t sys_clk_hz = clock_get_hz(clk_sys); // [cite: uploaded:my_projects/servo_controller.cpp]
-    float divider = static_cast<float>(sys_clk_hz) / 1000000.0f; // [cite: uploaded:my_projects/servo_controller.cpp]
-    if (divider < 1.0f) divider = 1.0f; // [cite: uploaded:my_projects/servo_controller.cpp]
-    if (divider >= 256.0f) divider = 255.0f + 255.0f/256.0f; // [cite: uploaded:my_projects/servo_controller.cpp]
-    s_pwm_wrap_value = static_cast<uint32_t>(roundf( (float)sys_clk_hz / (divider * PWM_FREQUENCY) )) - 1; // [cite: uploaded:my_projects/servo_controller.cpp]
+    float divider;
+    uint32_t wrap;
+    compute_pwm_timing(s_frame_rate_hz, &divider, &wrap);
 
     s_pwm_config = pwm_get_default_config(); // [cite: uploaded:my_projects/servo_controller.cpp]
     pwm_config_set_clkdiv(&s_pwm_config, divider); // [cite: uploaded:my_projects/servo_controller.cpp]
-    pwm_config_set_wrap(&s_pwm_config, s_pwm_wrap_value); // [cite: uploaded:my_projects/servo_controller.cpp]
+    pwm_config_set_wrap(&s_pwm_config, wrap); // [cite: uploaded:my_projects/servo_controller.cpp]
     pwm_init(s_pwm_slice_num, &s_pwm_config, true); // [cite: uploaded:my_projects/servo_controller.cpp]
+    record_pwm_timing(divider, wrap);
+    s_pwm_running = true;
 
-    float effective_freq = (float)sys_clk_hz / (divider * (s_pwm_wrap_value + 1)); // [cite: uploaded:my_projects/servo_controller.cpp]
-    printf("  PWM Slice: %u, Sys Clock: %lu Hz, Divider: %.2f, Wrap Val: %lu\n",
+    printf("  PWM Slice: %u, Sys Clock: %lu Hz, Divider: %.4f, Wrap Val: %lu\n",
            s_pwm_slice_num, sys_clk_hz, divider, s_pwm_wrap_value); // [cite: uploaded:my_projects/servo_controller.cpp]
-    printf("  Target Freq: %.1f Hz, Effective Freq: %.2f Hz\n", PWM_FREQUENCY, effective_freq); // [cite: uploaded:my_projects/servo_controller.cpp]
+    printf("  Target Freq: %.1f Hz, Effective Freq: %.2f Hz\n", s_frame_rate_hz, 1.0f / s_frame_period_s); // [cite: uploaded:my_projects/servo_controller.cpp]
+
+    // Calibration saved by servo_calibrate() replaces the defaults
+    float stored;
+    float frame_us = current_frame_period_us();
+    if (config_store_get_float(CONFIG_KEY_SERVO_MIN_PULSE_US, &stored) && pulse_fits_frame(stored, frame_us)) s_min_pulse_us = stored;
+    if (config_store_get_float(CONFIG_KEY_SERVO_MAX_PULSE_US, &stored) && pulse_fits_frame(stored, frame_us)) s_max_pulse_us = stored;
+    if (config_store_get_float(CONFIG_KEY_SERVO_TRAVEL_TIME_S, &stored)) s_travel_time_s = stored;
+    printf("  Pulse range %.1f-%.1f us, travel time %.0f ms\n", s_min_pulse_us, s_max_pulse_us, s_travel_time_s * 1000.0f);
 
     // Set initial position using the *current* (default) max pulse width for position 0.0
     // This matches the behavior in the original main.cpp where it set position 1.0 initially
     // which used MAX_PULSE_US. Let's keep it consistent.
     printf("Setting initial servo position to 0.0 (using MAX pulse width %.1f us)...\n", s_max_pulse_us); // [cite: uploaded:my_projects/servo_controller.cpp]
-    servo_set_position(0.0f); // Use the public function which now uses the variables
+    servo_motion_init(&s_motion, DEFAULT_SERVO_MOTION_LIMITS, 0.0f);
+    rebuild_level_map();
+    pwm_set_gpio_level(SERVO_PIN, servo_level_for_position_q16(0));
+
+    // From here on the frame interrupt owns the PWM level
+    pwm_clear_irq(s_pwm_slice_num);
+    pwm_set_irq_enabled(s_pwm_slice_num, true);
+    irq_add_shared_handler(PWM_IRQ_WRAP_0, servo_frame_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(PWM_IRQ_WRAP_0, true);
+
+    if (SERVO_FEEDBACK_ENABLED) {
+        feedback_init();
+    }
 
 
     printf("Servo Initialized (PWM started, set to position 0.0).\n");
@@ -118,16 +267,162 @@ void servo_set_position(float position) { // [cite: uploaded:my_projects/servo_c
     if (position < 0.0f) position = 0.0f; // [cite: uploaded:my_projects/servo_controller.cpp]
     if (position > 1.0f) position = 1.0f; // [cite: uploaded:my_projects/servo_controller.cpp]
 
-    // Interpolate pulse width using the *current* min/max settings
-    float pulse_us = s_min_pulse_us + (s_max_pulse_us - s_min_pulse_us) * position; // Uses variables now
-    uint16_t level = calculate_pwm_level(pulse_us); // [cite: uploaded:my_projects/servo_controller.cpp]
+    // The frame interrupt moves the output towards it; nothing waits here
+    uint32_t ints = save_and_disable_interrupts();
+    servo_motion_set_target(&s_motion, position);
+    s_motion_complete = servo_motion_is_complete(&s_motion);
+    restore_interrupts(ints);
+}
+
+uint16_t servo_level_for_position_q16(uint32_t position_q16) {
+    if (position_q16 > SERVO_POSITION_ONE_Q16) position_q16 = SERVO_POSITION_ONE_Q16;
+    // One 32x32->64 multiply; +0x8000 rounds to the nearest level
+    uint32_t level = (uint32_t)(((uint64_t)s_level_span_q16 * position_q16) >> 16) + s_level_base_q16;
+    level = (level + 0x8000u) >> 16;
+    if (level > s_pwm_wrap_value) level = s_pwm_wrap_value; // [cite: uploaded:my_projects/servo_controller.cpp]
+    return (uint16_t)level;
+}
+
+/*
+ * The level and the wrap are double-buffered by the slice and take effect at the
+ * next wrap, but the divider applies at once. So the change waits for the low
+ * part of a frame: past the longest pulse the calibration allows and not too near
+ * the wrap. The frame it lands in ends with an odd-length gap; every pulse stays whole.
+ */
+bool servo_set_frame_rate_hz(float hz) {
+    if (hz < SERVO_MIN_FRAME_RATE_HZ || hz > SERVO_MAX_FRAME_RATE_HZ) {
+        printf("Servo frame rate must be %.0f-%.0f Hz\n", SERVO_MIN_FRAME_RATE_HZ, SERVO_MAX_FRAME_RATE_HZ);
+        return false;
+    }
+    // Against the frame the divider and wrap actually give, which rounding can shorten
+    float divider;
+    uint32_t wrap;
+    compute_pwm_timing(hz, &divider, &wrap);
+    float frame_us = divider * (float)(wrap + 1) * 1000000.0f / (float)clock_get_hz(clk_sys);
+    float longest_pulse_us = fmaxf(s_min_pulse_us, s_max_pulse_us);
+    if (!pulse_fits_frame(longest_pulse_us, frame_us)) {
+        printf("A %.1f Hz frame is too short for a %.0f us pulse\n", hz, longest_pulse_us);
+        return false;
+    }
+    s_frame_rate_hz = hz;
+    if (!s_pwm_running) {
+        return true; // servo_init() starts at this rate
+    }
+
+    uint32_t guard = (uint32_t)(FRAME_RATE_CHANGE_GUARD_US * s_counts_per_us) + 1;
+    uint32_t low_start = (uint32_t)(longest_pulse_us * s_counts_per_us) + guard;
+    uint32_t low_end = s_pwm_wrap_value - guard;
+    while (true) {
+        uint32_t ints = save_and_disable_interrupts();
+        uint32_t count = pwm_get_counter(s_pwm_slice_num);
+        if (count > low_start && count < low_end) {
+            pwm_set_clkdiv(s_pwm_slice_num, divider);
+            pwm_set_wrap(s_pwm_slice_num, wrap);
+            record_pwm_timing(divider, wrap);
+            rebuild_level_map();
+            pwm_set_gpio_level(SERVO_PIN, servo_level_for_position_q16(position_to_q16(s_motion.position)));
+            restore_interrupts(ints);
+            break;
+        }
+        restore_interrupts(ints);
+        tight_loop_contents(); // At most one frame
+    }
+    printf("Servo frame rate set to %.2f Hz (divider %.4f, wrap %lu)\n",
+           1.0f / s_frame_period_s, divider, (unsigned long)wrap);
+    return true;
+}
+
+float servo_get_frame_rate_hz() {
+    return s_pwm_running ? 1.0f / s_frame_period_s : s_frame_rate_hz;
+}
+
+float servo_get_position() {
+    return s_motion.position;
+}
+
+bool servo_is_motion_complete() {
+    return s_motion_complete;
+}
+
+void servo_set_motion_callback(ServoMotionCallback callback, void* context) {
+    uint32_t ints = save_and_disable_interrupts();
+    s_motion_callback = callback;
+    s_motion_callback_context = context;
+    restore_interrupts(ints);
+}
+
+void servo_set_motion_limits(float max_speed, float max_accel) {
+    uint32_t ints = save_and_disable_interrupts();
+    s_motion.limits.max_speed = (max_speed > 0.0f) ? max_speed : 0.0f;
+    s_motion.limits.max_accel = (max_accel > 0.0f) ? max_accel : 0.0f;
+    restore_interrupts(ints);
+}
+
+float servo_get_max_speed() {
+    return s_motion.limits.max_speed;
+}
+
+float servo_get_max_accel() {
+    return s_motion.limits.max_accel;
+}
+
+bool servo_has_feedback() {
+    return s_feedback_dma_channel >= 0;
+}
+
+float servo_get_feedback_raw() {
+    if (!servo_has_feedback()) {
+        return 0.0f;
+    }
+    return servo_feedback_average(s_feedback_ring, SERVO_FEEDBACK_AVERAGE);
+}
 
-    // Debug Print
-    printf("DEBUG SERVO: set_position(%.2f) -> pulse=%.0fus (min=%.0f, max=%.0f), level=%u (wrap=%lu)\n",
-           position, pulse_us, s_min_pulse_us, s_max_pulse_us, level, s_pwm_wrap_value); // [cite: uploaded:my_projects/servo_controller.cpp]
+float servo_get_measured_position() {
+    if (!servo_has_feedback() || !servo_feedback_cal_valid(s_feedback_cal)) {
+        return -1.0f;
+    }
+    return servo_feedback_position(s_feedback_cal, servo_get_feedback_raw());
+}
 
-    // Set the PWM duty cycle
-    pwm_set_gpio_level(SERVO_PIN, level); // [cite: uploaded:my_projects/servo_controller.cpp]
+bool servo_calibrate_feedback() {
+    if (!servo_has_feedback()) {
+        return false;
+    }
+    servo_set_position(0.0f);
+    sleep_ms(FEEDBACK_REST_MS);
+    s_feedback_cal.raw_at_min = servo_get_feedback_raw();
+    servo_set_position(1.0f);
+    sleep_ms(FEEDBACK_REST_MS);
+    s_feedback_cal.raw_at_max = servo_get_feedback_raw();
+    printf("Servo feedback: %.0f counts at 0.0, %.0f counts at 1.0\n",
+           s_feedback_cal.raw_at_min, s_feedback_cal.raw_at_max);
+    return servo_feedback_cal_valid(s_feedback_cal);
+}
+
+bool servo_measure_latency(float from_position, float to_position, float* start_s, float* settle_s) {
+    if (servo_get_measured_position() < 0.0f) {
+        return false; // No feedback or not calibrated
+    }
+    servo_set_position(from_position);
+    sleep_ms(FEEDBACK_REST_MS);
+
+    ServoLatencyTest test;
+    servo_latency_start(&test, from_position, to_position, time_us_64());
+    servo_set_position(to_position);
+    while (!servo_latency_update(&test, time_us_64(), servo_get_measured_position())) {
+        sleep_us(SERVO_LATENCY_POLL_US);
+    }
+    *start_s = servo_latency_start_s(&test);
+    *settle_s = servo_latency_settle_s(&test);
+    return test.settled;
+}
+
+void servo_set_travel_time_s(float seconds) {
+    s_travel_time_s = (seconds > 0.0f) ? seconds : 0.0f;
+}
+
+float servo_get_travel_time_s() {
+    return s_travel_time_s;
 }
 
 // --- Getter/Setter Implementations ---
@@ -135,20 +430,32 @@ float servo_get_min_pulse_us() {
     return s_min_pulse_us;
 }
 
-void servo_set_min_pulse_us(float us) {
-    // Add validation if desired (e.g., check > 0, check < max_pulse)
+bool servo_set_min_pulse_us(float us) {
+    if (!pulse_fits_frame(us, current_frame_period_us())) {
+        printf("A %.1f us pulse doesn't fit the %.0f us frame\n", us, current_frame_period_us());
+        return false;
+    }
     printf("Setting min pulse width to: %.1f us\n", us);
     s_min_pulse_us = us;
+    rebuild_level_map();
+    refresh_level();
+    return true;
 }
 
 float servo_get_max_pulse_us() {
     return s_max_pulse_us;
 }
 
-void servo_set_max_pulse_us(float us) {
-    // Add validation if desired (e.g., check > 0, check > min_pulse)
+bool servo_set_max_pulse_us(float us) {
+    if (!pulse_fits_frame(us, current_frame_period_us())) {
+        printf("A %.1f us pulse doesn't fit the %.0f us frame\n", us, current_frame_period_us());
+        return false;
+    }
     printf("Setting max pulse width to: %.1f us\n", us);
     s_max_pulse_us = us;
+    rebuild_level_map();
+    refresh_level();
+    return true;
 }
 
 
@@ -160,8 +467,7 @@ void servo_calibrate() {
 
     // Get New Min Pulse
     float new_min = read_float_from_serial("\nEnter new MIN pulse width (us): ");
-    if (new_min > 0) { // Basic validation: must be positive
-        servo_set_min_pulse_us(new_min);
+    if (new_min > 0 && servo_set_min_pulse_us(new_min)) { // Positive and inside the frame
         printf("Moving servo to new MIN (position 0.0)...");
         servo_set_position(0.0f);
         sleep_ms(1000); // Pause to observe
@@ -172,14 +478,13 @@ void servo_calibrate() {
 
     // Get New Max Pulse
     float new_max = read_float_from_serial("\nEnter new MAX pulse width (us): ");
-     if (new_max > 0 && new_max > servo_get_min_pulse_us()) { // Basic validation: positive and > min
-        servo_set_max_pulse_us(new_max);
+     if (new_max > 0 && new_max > servo_get_min_pulse_us() && servo_set_max_pulse_us(new_max)) { // Positive, > min, inside the frame
         printf("Moving servo to new MAX (position 1.0)...");
         servo_set_position(1.0f);
         sleep_ms(1000); // Pause to observe
         printf(" Done.\n");
     } else {
-        printf("Invalid input for max pulse (must be > 0 and > min pulse). Keeping current value.\n");
+        printf("Invalid input for max pulse (must be > 0, > min pulse and inside the frame). Keeping current value.\n");
     }
 
     // Optional: Move back to center or min?
@@ -189,8 +494,9 @@ void servo_calibrate() {
     printf(" Done.\n");
 
     printf("--- Servo Calibration Complete ---\n");
-    // NOTE: These settings are NOT saved persistently. They will reset on reboot.
-    // Saving requires extra code (e.g., writing to flash).
+    bool saved = config_store_set_float(CONFIG_KEY_SERVO_MIN_PULSE_US, s_min_pulse_us);
+    saved = config_store_set_float(CONFIG_KEY_SERVO_MAX_PULSE_US, s_max_pulse_us) && saved;
+    printf(saved ? "Calibration saved to flash.\n" : "Calibration will be saved once the motor is stopped.\n");
 }
 
 
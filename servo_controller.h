@@ -2,27 +2,144 @@
 #define SERVO_CONTROLLER_H
 
 #include "stdlib.h"
+#include <stdint.h>
 
 // --- Configuration ---
 // Define the GPIO pin connected to the servo signal line
 // Ensure this pin is not used by other peripherals (stepper, SD card)
 const int SERVO_PIN = 15; // Example pin, change if needed [cite: uploaded:my_projects/servo_controller.h]
+const uint32_t SERVO_POSITION_ONE_Q16 = 65536; // Position 1.0 in Q16 fixed point
+const float SERVO_MIN_FRAME_RATE_HZ = 40.0f;    // Frame rate range; above 50 Hz is for digital servos only
+const float SERVO_MAX_FRAME_RATE_HZ = 333.0f;
+
+// Optional position feedback: the servo's pot wiper (servos with a 4th feedback wire)
+// on an ADC pin. Enables the measured position and the latency test.
+const bool SERVO_FEEDBACK_ENABLED = false;
+const int SERVO_FEEDBACK_ADC_PIN = 26; // ADC0
+
+// --- Public Types ---
+
+/**
+ * @brief Called when a servo move completes (output on target, speed zero).
+ * Runs in the PWM frame interrupt: keep it short and don't print.
+ */
+typedef void (*ServoMotionCallback)(float position, void* context);
 
 // --- Public Function Declarations ---
 
 /**
- * @brief Initializes the PWM hardware for the servo pin.
+ * @brief Initializes the PWM hardware for the servo pin and starts the motion engine
+ * (a PWM wrap interrupt on the calling core, once per frame).
  * Must be called once during setup before using other servo functions.
  */
 void servo_init(); // [cite: uploaded:my_projects/servo_controller.h]
 
 /**
- * @brief Sets the servo position based on current min/max pulse settings.
+ * @brief Sets the servo target position based on current min/max pulse settings.
+ * Returns at once: the motion engine moves the output there within the slew and
+ * acceleration limits, starting with the next PWM frame.
  * @param position A value from 0.0 (min pulse) to 1.0 (max pulse).
  * Values outside this range will be clamped.
  */
 void servo_set_position(float position); // [cite: uploaded:my_projects/servo_controller.h]
 
+/**
+ * @brief Converts a Q16 position (0 to SERVO_POSITION_ONE_Q16) to the PWM level with the
+ * current calibration. Integer multiply and shift only, so high-rate loops and
+ * interrupts can use it freely; the mapping is rebuilt when the calibration changes.
+ */
+uint16_t servo_level_for_position_q16(uint32_t position_q16);
+
+/**
+ * @brief Sets the PWM frame rate. The clock divider and wrap are recomputed for
+ * the finest pulse resolution at that rate. The change is made in the low part of a
+ * frame, so no pulse is cut short; this waits for that, at most one frame.
+ * Can be called before servo_init() to pick the starting rate (default 50 Hz).
+ * @param hz SERVO_MIN_FRAME_RATE_HZ to SERVO_MAX_FRAME_RATE_HZ. The frame must be
+ *        longer than the calibrated pulses. Analog servos need 50 Hz.
+ * @return False (setting unchanged) if the rate is out of range.
+ */
+bool servo_set_frame_rate_hz(float hz);
+
+/**
+ * @brief Gets the effective frame rate (after divider and wrap rounding once running).
+ */
+float servo_get_frame_rate_hz();
+
+/**
+ * @brief Gets the position the PWM is outputting now (on its way to the target).
+ */
+float servo_get_position();
+
+/**
+ * @brief Checks whether the output has reached the last target. This is the
+ * commanded signal; the servo itself still needs its own travel time after it.
+ */
+bool servo_is_motion_complete();
+
+/**
+ * @brief Registers a function to call each time a move completes (nullptr to clear).
+ */
+void servo_set_motion_callback(ServoMotionCallback callback, void* context);
+
+/**
+ * @brief Sets the motion engine limits, in servo travel (0.0-1.0) per second.
+ * @param max_speed Slew limit; 0 = unlimited.
+ * @param max_accel Acceleration limit; 0 = unlimited. With both 0 the output
+ *        jumps to the target on the next frame.
+ */
+void servo_set_motion_limits(float max_speed, float max_accel);
+
+float servo_get_max_speed();
+float servo_get_max_accel();
+
+/**
+ * @brief Checks whether the feedback pot is being sampled (SERVO_FEEDBACK_ENABLED).
+ */
+bool servo_has_feedback();
+
+/**
+ * @brief Gets the filtered feedback reading in ADC counts (0-4095).
+ * @return 0 without feedback.
+ */
+float servo_get_feedback_raw();
+
+/**
+ * @brief Gets the servo position measured by the feedback pot.
+ * @return Travel units (0.0-1.0, may overshoot slightly); negative without
+ *         feedback or before servo_calibrate_feedback().
+ */
+float servo_get_measured_position();
+
+/**
+ * @brief Blocking: rests the servo at 0.0 and at 1.0 and records the feedback
+ * reading at each end. Leaves the servo at 1.0.
+ * @return True if the readings are far enough apart to use.
+ */
+bool servo_calibrate_feedback();
+
+/**
+ * @brief Blocking latency test: rests the servo at from_position, commands
+ * to_position and follows the feedback until it settles (or times out).
+ * Needs a calibrated feedback pot.
+ * @param start_s Output: command to start of motion (s).
+ * @param settle_s Output: command to settled on the target (s).
+ * @return True if the servo settled.
+ */
+bool servo_measure_latency(float from_position, float to_position, float* start_s, float* settle_s);
+
+/**
+ * @brief Sets the time the servo takes to complete a flip once commanded (command to
+ * end of travel). The simulation commands flips this much early.
+ * @param seconds Travel time, >= 0.
+ */
+void servo_set_travel_time_s(float seconds);
+
+/**
+ * @brief Gets the servo travel time used as the flip lead.
+ */
+float servo_get_travel_time_s();
+
 /**
  * @brief Gets the current minimum servo pulse width in microseconds.
  * @return Minimum pulse width (us).
@@ -32,8 +149,9 @@ float servo_get_min_pulse_us();
 /**
  * @brief Sets the minimum servo pulse width.
  * @param us New minimum pulse width in microseconds.
+ * @return False (setting unchanged) if the pulse is negative or doesn't fit the frame.
  */
-void servo_set_min_pulse_us(float us);
+bool servo_set_min_pulse_us(float us);
 
 /**
  * @brief Gets the current maximum servo pulse width in microseconds.
@@ -44,8 +162,9 @@ float servo_get_max_pulse_us();
 /**
  * @brief Sets the maximum servo pulse width.
  * @param us New maximum pulse width in microseconds.
+ * @return False (setting unchanged) if the pulse is negative or doesn't fit the frame.
  */
-void servo_set_max_pulse_us(float us);
+bool servo_set_max_pulse_us(float us);
 
 /**
  * @brief Enters a blocking serial routine to calibrate servo min/max pulse widths.
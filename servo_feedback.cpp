@@ -0,0 +1,75 @@
+#include "servo_feedback.h"
+#include <cmath> // For fabsf
+
+// --- Public Function Implementations ---
+
+float servo_feedback_average(const uint16_t* samples, size_t count) {
+    if (count == 0) {
+        return 0.0f;
+    }
+    uint32_t sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += samples[i];
+    }
+    return (float)sum / (float)count;
+}
+
+bool servo_feedback_cal_valid(const ServoFeedbackCal& cal) {
+    return fabsf(cal.raw_at_max - cal.raw_at_min) >= (float)SERVO_FEEDBACK_MIN_SPAN;
+}
+
+float servo_feedback_position(const ServoFeedbackCal& cal, float raw) {
+    return (raw - cal.raw_at_min) / (cal.raw_at_max - cal.raw_at_min);
+}
+
+void servo_latency_start(ServoLatencyTest* test, float from_position, float to_position, uint64_t command_us) {
+    test->from_position = from_position;
+    test->to_position = to_position;
+    test->command_us = command_us;
+    test->start_us = 0;
+    test->band_entry_us = 0;
+    test->settled = false;
+    test->timed_out = false;
+}
+
+/*
+ * Distances are measured along the commanded step, so one threshold works in
+ * both directions. Settling needs SERVO_LATENCY_SETTLE_HOLD_S inside the band;
+ * an overshoot that leaves the band restarts the hold, and the settle time is
+ * the entry that held.
+ */
+bool servo_latency_update(ServoLatencyTest* test, uint64_t now_us, float measured_position) {
+    if (test->settled || test->timed_out) {
+        return true;
+    }
+    float step = test->to_position - test->from_position;
+    float travelled = (measured_position - test->from_position) / step; // 0 at the start, 1 on target
+
+    if (test->start_us == 0 && travelled >= SERVO_LATENCY_START_FRACTION) {
+        test->start_us = now_us;
+    }
+    if (test->start_us != 0 && fabsf(1.0f - travelled) <= SERVO_LATENCY_SETTLE_BAND) {
+        if (test->band_entry_us == 0) {
+            test->band_entry_us = now_us;
+        }
+        if ((float)(now_us - test->band_entry_us) * 1e-6f >= SERVO_LATENCY_SETTLE_HOLD_S) {
+            test->settled = true;
+            return true;
+        }
+    } else {
+        test->band_entry_us = 0;
+    }
+    if ((float)(now_us - test->command_us) * 1e-6f >= SERVO_LATENCY_TIMEOUT_S) {
+        test->timed_out = true;
+        return true;
+    }
+    return false;
+}
+
+float servo_latency_start_s(const ServoLatencyTest* test) {
+    return (test->start_us != 0) ? (float)(test->start_us - test->command_us) * 1e-6f : -1.0f;
+}
+
+float servo_latency_settle_s(const ServoLatencyTest* test) {
+    return test->settled ? (float)(test->band_entry_us - test->command_us) * 1e-6f : -1.0f;
+}
@@ -0,0 +1,90 @@
+#ifndef SERVO_FEEDBACK_H
+#define SERVO_FEEDBACK_H
+
+/**
+ * @file servo_feedback.h
+ * @brief Servo position from the feedback pot, and the actuation latency test.
+ *
+ * The ADC samples the pot continuously into a ring; the position is the average
+ * of the ring (a moving-average filter over SERVO_FEEDBACK_AVERAGE samples) mapped
+ * through the readings taken at positions 0.0 and 1.0. The latency test is fed
+ * measured positions after a command and finds when the servo started to move
+ * and when it settled on the target.
+ * Pure C++ with no SDK dependencies, so the test runs on the host against a
+ * simulated feedback signal.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+// --- Public Configuration ---
+const uint32_t SERVO_FEEDBACK_SAMPLE_HZ = 20000; // ADC rate (free-running)
+const size_t SERVO_FEEDBACK_AVERAGE = 64;        // Ring size: 3.2 ms moving average
+const uint32_t SERVO_FEEDBACK_MIN_SPAN = 200;    // ADC counts between the ends for a usable calibration
+
+const uint32_t SERVO_LATENCY_POLL_US = 200;       // Test sample period
+const float SERVO_LATENCY_START_FRACTION = 0.05f; // Moved this fraction of the step: motion started
+const float SERVO_LATENCY_SETTLE_BAND = 0.02f;    // Within this fraction of the step of the target...
+const float SERVO_LATENCY_SETTLE_HOLD_S = 0.1f;   // ...for this long: settled
+const float SERVO_LATENCY_TIMEOUT_S = 2.0f;
+
+// --- Public Types ---
+
+// Averaged ADC readings with the servo resting at each end
+struct ServoFeedbackCal {
+    float raw_at_min;   // Position 0.0
+    float raw_at_max;   // Position 1.0
+};
+
+struct ServoLatencyTest {
+    float from_position;
+    float to_position;
+    uint64_t command_us;
+    uint64_t start_us;        // First sample past the start threshold (0 = not yet)
+    uint64_t band_entry_us;   // Start of the current run inside the settle band (0 = outside)
+    bool settled;
+    bool timed_out;
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Mean of a block of ADC samples.
+ */
+float servo_feedback_average(const uint16_t* samples, size_t count);
+
+/**
+ * @brief True if the ends are far enough apart to resolve positions.
+ */
+bool servo_feedback_cal_valid(const ServoFeedbackCal& cal);
+
+/**
+ * @brief Maps an averaged ADC reading to servo travel (0.0-1.0, not clamped).
+ * Works with either pot direction.
+ */
+float servo_feedback_position(const ServoFeedbackCal& cal, float raw);
+
+/**
+ * @brief Starts a measurement: the move from from_position to to_position was
+ * commanded at command_us.
+ */
+void servo_latency_start(ServoLatencyTest* test, float from_position, float to_position, uint64_t command_us);
+
+/**
+ * @brief Feeds one measured position.
+ * @return True once the test is over (settled or timed out).
+ */
+bool servo_latency_update(ServoLatencyTest* test, uint64_t now_us, float measured_position);
+
+/**
+ * @brief Command to start of motion, in seconds; negative if it never moved.
+ */
+float servo_latency_start_s(const ServoLatencyTest* test);
+
+/**
+ * @brief Command to settled on the target (entering the band for the last time),
+ * in seconds; negative if it never settled.
+ */
+float servo_latency_settle_s(const ServoLatencyTest* test);
+
+#endif // SERVO_FEEDBACK_H
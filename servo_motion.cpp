@@ -0,0 +1,61 @@
+#include "servo_motion.h"
+#include <cmath> // For sqrtf, fabsf
+
+// --- Public Function Implementations ---
+
+void servo_motion_init(ServoMotion* motion, const ServoMotionLimits& limits, float position) {
+    motion->limits = limits;
+    motion->position = position;
+    motion->velocity = 0.0f;
+    motion->target = position;
+}
+
+void servo_motion_set_target(ServoMotion* motion, float target) {
+    motion->target = target;
+}
+
+/*
+ * Per frame: the speed wanted is the lower of the slew limit and the speed that
+ * can still be braked to zero over the remaining distance (v = sqrt(2 a d));
+ * the actual speed moves towards it by at most max_accel * dt. A frame that would
+ * reach or pass the target ends the move on it.
+ */
+bool servo_motion_step(ServoMotion* motion, float dt_s) {
+    if (servo_motion_is_complete(motion)) {
+        return false;
+    }
+    const ServoMotionLimits& lim = motion->limits;
+    float error = motion->target - motion->position;
+    float distance = fabsf(error);
+
+    if (lim.max_speed <= 0.0f && lim.max_accel <= 0.0f) {
+        motion->position = motion->target; // Unlimited: jump in one frame
+        motion->velocity = 0.0f;
+        return true;
+    }
+
+    float wanted = (lim.max_accel > 0.0f) ? sqrtf(2.0f * lim.max_accel * distance) : distance / dt_s;
+    if (lim.max_speed > 0.0f && wanted > lim.max_speed) wanted = lim.max_speed;
+    if (error < 0.0f) wanted = -wanted;
+
+    float velocity = wanted;
+    if (lim.max_accel > 0.0f) {
+        float max_change = lim.max_accel * dt_s;
+        if (velocity > motion->velocity + max_change) velocity = motion->velocity + max_change;
+        if (velocity < motion->velocity - max_change) velocity = motion->velocity - max_change;
+    }
+
+    float move = velocity * dt_s;
+    if ((error > 0.0f && move >= error) || (error < 0.0f && move <= error)) {
+        motion->position = motion->target;
+        motion->velocity = 0.0f;
+        return true;
+    }
+    motion->position += move;
+    motion->velocity = velocity;
+    return false;
+}
+
+bool servo_motion_is_complete(const ServoMotion* motion) {
+    return motion->position == motion->target && motion->velocity == 0.0f;
+}
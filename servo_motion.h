@@ -0,0 +1,53 @@
+#ifndef SERVO_MOTION_H
+#define SERVO_MOTION_H
+
+/**
+ * @file servo_motion.h
+ * @brief Slew- and acceleration-limited servo set-point interpolation.
+ *
+ * Advanced once per PWM frame: moves the commanded position towards the target
+ * with a trapezoidal velocity profile, braking so it arrives with zero speed.
+ * Positions are in servo travel units (0.0 = min pulse, 1.0 = max pulse).
+ * Pure C++ with no SDK dependencies.
+ */
+
+// --- Public Types ---
+
+// 0 for either limit means unlimited
+struct ServoMotionLimits {
+    float max_speed;  // Travel per second
+    float max_accel;  // Travel per second^2
+};
+
+struct ServoMotion {
+    ServoMotionLimits limits;
+    float position;   // Commanded position (what the PWM outputs)
+    float velocity;   // Travel per second
+    float target;
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Starts at rest at the given position (also the target).
+ */
+void servo_motion_init(ServoMotion* motion, const ServoMotionLimits& limits, float position);
+
+/**
+ * @brief Sets a new target; the motion continues from the current position and speed.
+ */
+void servo_motion_set_target(ServoMotion* motion, float target);
+
+/**
+ * @brief Advances one frame.
+ * @param dt_s Frame period.
+ * @return True if the motion completed during this frame (reached the target and stopped).
+ */
+bool servo_motion_step(ServoMotion* motion, float dt_s);
+
+/**
+ * @brief True once the position is on the target with no speed left.
+ */
+bool servo_motion_is_complete(const ServoMotion* motion);
+
+#endif // SERVO_MOTION_H
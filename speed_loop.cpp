@@ -0,0 +1,80 @@
+#include "speed_loop.h"
+
+// --- Public Function Implementations ---
+
+SpeedLoopParams speed_loop_default_params(float counts_per_step, float stall_min_pps) {
+    SpeedLoopParams params;
+    params.kp = 0.05f;             // Low: the rotor rings around the field at low speed
+    params.ki = 1.0f;              // Integral time of 50 ms
+    params.max_correction = 0.05f; // +-5% of the planned rate
+    params.filter_tau_s = 0.05f;
+    params.counts_per_step = counts_per_step;
+    params.stall_min_pps = stall_min_pps;
+    params.stall_fraction = 0.5f;
+    params.stall_time_s = 0.1f;    // Well past the filter lag on a full-rate deceleration
+    return params;
+}
+
+void speed_loop_init(SpeedLoop* loop, const SpeedLoopParams& params) {
+    loop->params = params;
+    loop->last_count = 0;
+    speed_loop_reset(loop);
+}
+
+void speed_loop_reset(SpeedLoop* loop) {
+    loop->primed = false;
+    loop->measured_pps = 0.0f;
+    loop->integral = 0.0f;
+    loop->correction_pps = 0.0f;
+    loop->stall_timer_s = 0.0f;
+    loop->stalled = false;
+}
+
+float speed_loop_update(SpeedLoop* loop, int32_t encoder_count, float reference_pps, float dt_s, bool correct) {
+    const SpeedLoopParams& p = loop->params;
+    int32_t delta = (int32_t)((uint32_t)encoder_count - (uint32_t)loop->last_count); // Wrap-safe
+    loop->last_count = encoder_count;
+    if (!loop->primed || dt_s <= 0.0f) {
+        loop->primed = true;
+        return 1.0f;
+    }
+
+    // A few counts per period at low speed, so low-pass the raw rate
+    float raw_pps = (float)delta / p.counts_per_step / dt_s;
+    loop->measured_pps += (raw_pps - loop->measured_pps) * (dt_s / (p.filter_tau_s + dt_s));
+
+    // Stall: well below the planned rate for stall_time_s (the filter lag is far shorter)
+    if (reference_pps > p.stall_min_pps && loop->measured_pps < p.stall_fraction * reference_pps) {
+        loop->stall_timer_s += dt_s;
+        if (loop->stall_timer_s >= p.stall_time_s) {
+            loop->stalled = true;
+        }
+    } else {
+        loop->stall_timer_s = 0.0f;
+    }
+
+    if (!correct || reference_pps <= 0.0f) {
+        loop->integral = 0.0f;
+        loop->correction_pps = 0.0f;
+        return 1.0f;
+    }
+
+    float error = reference_pps - loop->measured_pps;
+    float limit = p.max_correction * reference_pps;
+    float proportional = p.kp * error;
+    float integral = loop->integral + p.ki * error * dt_s;
+
+    // Conditional integration: hold the integrator while the output is saturated
+    float correction = proportional + integral;
+    if (correction > limit) {
+        correction = limit;
+    } else if (correction < -limit) {
+        correction = -limit;
+    } else {
+        loop->integral = integral;
+    }
+    loop->correction_pps = correction;
+
+    // Planned interval * reference / (reference + correction) gives the corrected rate
+    return reference_pps / (reference_pps + correction);
+}
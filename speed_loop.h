@@ -0,0 +1,74 @@
+#ifndef SPEED_LOOP_H
+#define SPEED_LOOP_H
+
+/**
+ * @file speed_loop.h
+ * @brief Encoder speed loop for the stepper: PI correction on top of the planned
+ * step rate (the feed-forward), plus stall detection.
+ *
+ * Updated at a fixed period with the encoder count. The planned rate stays the
+ * reference; the loop only trims the STEP rate by a bounded fraction so the
+ * measured speed matches it, and reports a stall once the measured speed has
+ * stayed far below the reference for a while. Speeds are in full steps per second.
+ * Pure C++ with no SDK dependencies, so it runs unchanged against a simulated
+ * encoder on the host.
+ */
+
+#include <cstdint>
+
+// --- Public Types ---
+
+struct SpeedLoopParams {
+    float kp;                   // Proportional gain (PPS of correction per PPS of error)
+    float ki;                   // Integral gain (PPS of correction per PPS*s of error)
+    float max_correction;       // Correction limit as a fraction of the reference
+    float filter_tau_s;         // Time constant of the measured-speed low-pass filter
+    float counts_per_step;      // Encoder counts per full step (4x quadrature)
+    float stall_min_pps;        // Stall detection only above this reference
+    float stall_fraction;       // Stalled while measured < fraction * reference...
+    float stall_time_s;         // ...for this long
+};
+
+struct SpeedLoop {
+    SpeedLoopParams params;
+    bool primed;                // Has a previous count to difference against
+    int32_t last_count;
+    float measured_pps;         // Filtered measured speed
+    float integral;             // Integrator state (PPS of correction)
+    float correction_pps;       // Last correction
+    float stall_timer_s;        // Time spent below the stall threshold
+    bool stalled;               // Latched until speed_loop_reset()
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Default tuning for the centrifuge axis: gentle gains and a small correction
+ * range, since a stepper already holds its speed unless it slips.
+ * @param counts_per_step Encoder counts per full step.
+ * @param stall_min_pps Reference below which stalls are not judged (e.g. the pull-in rate).
+ */
+SpeedLoopParams speed_loop_default_params(float counts_per_step, float stall_min_pps);
+
+/**
+ * @brief Initialises the loop (reset, no correction).
+ */
+void speed_loop_init(SpeedLoop* loop, const SpeedLoopParams& params);
+
+/**
+ * @brief Clears the integrator, filter and stall state (e.g. when a run starts).
+ * The next update only takes its count as the new starting point.
+ */
+void speed_loop_reset(SpeedLoop* loop);
+
+/**
+ * @brief Runs one loop period.
+ * @param encoder_count Raw encoder count (wraps; only differences are used).
+ * @param reference_pps Planned step rate (feed-forward), >= 0.
+ * @param dt_s Time since the previous update.
+ * @param correct True to apply PI correction; false only measures and watches for stalls.
+ * @return STEP interval scale to apply to planned intervals (1 = no correction).
+ */
+float speed_loop_update(SpeedLoop* loop, int32_t encoder_count, float reference_pps, float dt_s, bool correct);
+
+#endif // SPEED_LOOP_H
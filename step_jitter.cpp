@@ -0,0 +1,127 @@
+#include "step_jitter.h"
+#include <atomic>
+#include <algorithm> // For std::sort
+#include <cstdio>    // For printf
+
+// --- Module-Internal Configuration ---
+
+// Histogram bin edges in microseconds; bins are (-inf, e0), [e0, e1), ..., [eN, +inf)
+static const int32_t JITTER_BIN_EDGES_US[] = {-50, -20, -10, -5, -2, -1, 1, 2, 5, 10, 20, 50};
+static const size_t JITTER_BIN_COUNT = sizeof(JITTER_BIN_EDGES_US) / sizeof(JITTER_BIN_EDGES_US[0]) + 1;
+static const int JITTER_BAR_WIDTH = 40; // Characters for the fullest bin
+
+// --- Module-Internal State Variables ---
+static int32_t s_periodErrorNs[STEP_JITTER_CAPTURE_SIZE];
+static std::atomic<uint32_t> s_recorded{0};     // Periods recorded since arming (may exceed the buffer)
+static std::atomic<bool> s_armed{false};
+static std::atomic<bool> s_restart{true};       // Next edge starts a new sequence
+static uint32_t s_previousEdgeUs = 0;           // Producer only
+
+// --- Public Function Implementations ---
+
+void step_jitter_set_armed(bool armed) {
+    if (armed) {
+        s_armed.store(false, std::memory_order_relaxed);
+        s_recorded.store(0, std::memory_order_relaxed);
+        s_restart.store(true, std::memory_order_relaxed);
+    }
+    s_armed.store(armed, std::memory_order_release);
+}
+
+bool step_jitter_is_armed() {
+    return s_armed.load(std::memory_order_acquire);
+}
+
+void step_jitter_record_edge(uint32_t edge_us, uint32_t ideal_period_ns) {
+    if (!s_armed.load(std::memory_order_acquire)) {
+        s_restart.store(true, std::memory_order_relaxed);
+        return;
+    }
+    bool restart = s_restart.exchange(false, std::memory_order_relaxed);
+    uint32_t measured_us = edge_us - s_previousEdgeUs; // Wrap-safe
+    s_previousEdgeUs = edge_us;
+    if (restart || ideal_period_ns == 0) {
+        return; // No previous edge in this sequence to measure against
+    }
+
+    int64_t error_ns = (int64_t)measured_us * 1000 - (int64_t)ideal_period_ns;
+    if (error_ns > INT32_MAX) error_ns = INT32_MAX;
+    if (error_ns < INT32_MIN) error_ns = INT32_MIN;
+
+    uint32_t index = s_recorded.load(std::memory_order_relaxed);
+    s_periodErrorNs[index % STEP_JITTER_CAPTURE_SIZE] = (int32_t)error_ns;
+    s_recorded.store(index + 1, std::memory_order_release);
+}
+
+StepJitterStats step_jitter_compute_stats() {
+    StepJitterStats stats = {0, 0, 0, 0, 0};
+    uint32_t recorded = s_recorded.load(std::memory_order_acquire);
+    size_t count = (recorded < STEP_JITTER_CAPTURE_SIZE) ? recorded : STEP_JITTER_CAPTURE_SIZE;
+    if (count == 0) {
+        return stats;
+    }
+
+    int64_t sum = 0;
+    std::sort(s_periodErrorNs, s_periodErrorNs + count);
+    for (size_t i = 0; i < count; ++i) {
+        sum += s_periodErrorNs[i];
+    }
+    stats.count = count;
+    stats.min_ns = s_periodErrorNs[0];
+    stats.max_ns = s_periodErrorNs[count - 1];
+    stats.mean_ns = (int32_t)(sum / (int64_t)count);
+
+    // 99th percentile of |error|: walk in from both ends of the sorted array,
+    // dropping the largest magnitude each time, until 1% has been dropped
+    size_t lo = 0, hi = count - 1;
+    size_t drop = count / 100;
+    for (size_t i = 0; i < drop && lo < hi; ++i) {
+        int64_t low_mag = -(int64_t)s_periodErrorNs[lo];
+        int64_t high_mag = s_periodErrorNs[hi];
+        if (low_mag > high_mag) ++lo; else --hi;
+    }
+    int64_t low_mag = -(int64_t)s_periodErrorNs[lo];
+    int64_t high_mag = s_periodErrorNs[hi];
+    int64_t p99 = (low_mag > high_mag) ? low_mag : high_mag;
+    stats.p99_ns = (int32_t)((p99 > INT32_MAX) ? INT32_MAX : (p99 < 0 ? 0 : p99));
+    return stats;
+}
+
+void step_jitter_report(const char* source_label) {
+    step_jitter_set_armed(false);
+    uint32_t recorded = s_recorded.load(std::memory_order_acquire);
+    StepJitterStats stats = step_jitter_compute_stats();
+
+    printf("\n--- Step Period Error (%s) ---\n", source_label);
+    if (stats.count == 0) {
+        printf("No step periods captured. Arm capture, then run the test or a simulation.\n");
+        return;
+    }
+    printf("Periods: %u (of %lu recorded)\n", (unsigned int)stats.count, (unsigned long)recorded);
+    printf("min %.3f us, max %.3f us, p99 |err| %.3f us, mean %.3f us\n",
+           stats.min_ns / 1000.0f, stats.max_ns / 1000.0f, stats.p99_ns / 1000.0f, stats.mean_ns / 1000.0f);
+
+    // The capture is sorted now, so each bin is a contiguous run
+    size_t bins[JITTER_BIN_COUNT] = {0};
+    size_t bin = 0;
+    size_t largest = 0;
+    for (size_t i = 0; i < stats.count; ++i) {
+        while (bin < JITTER_BIN_COUNT - 1 && s_periodErrorNs[i] >= JITTER_BIN_EDGES_US[bin] * 1000) {
+            ++bin;
+        }
+        if (++bins[bin] > largest) largest = bins[bin];
+    }
+
+    for (size_t b = 0; b < JITTER_BIN_COUNT; ++b) {
+        if (b == 0) {
+            printf("        < %4ld us |", (long)JITTER_BIN_EDGES_US[0]);
+        } else if (b == JITTER_BIN_COUNT - 1) {
+            printf("       >= %4ld us |", (long)JITTER_BIN_EDGES_US[b - 1]);
+        } else {
+            printf("  %4ld .. %4ld us |", (long)JITTER_BIN_EDGES_US[b - 1], (long)JITTER_BIN_EDGES_US[b]);
+        }
+        int bar = (int)((bins[b] * JITTER_BAR_WIDTH + largest - 1) / largest);
+        for (int i = 0; i < bar; ++i) putchar('#');
+        printf(" %u\n", (unsigned int)bins[b]);
+    }
+}
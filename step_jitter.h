@@ -0,0 +1,66 @@
+#ifndef STEP_JITTER_H
+#define STEP_JITTER_H
+
+/**
+ * @file step_jitter.h
+ * @brief Step-edge timestamp capture and period-error histogram.
+ *
+ * The step path calls step_jitter_record_edge() from its interrupt on every
+ * rising STEP edge while capture is armed. Each edge is turned into a period
+ * error (measured period minus intended period) and kept in a ring buffer
+ * holding the most recent STEP_JITTER_CAPTURE_SIZE periods. The report sorts
+ * the buffer, so it is only done with capture disarmed.
+ * Pure C++ with no SDK dependencies.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+// --- Public Configuration ---
+const size_t STEP_JITTER_CAPTURE_SIZE = 4096; // Periods kept (most recent)
+
+// --- Public Types ---
+
+// Summary of the captured period errors, in nanoseconds
+struct StepJitterStats {
+    size_t count;      // Periods in the capture
+    int32_t min_ns;    // Most negative error (edge early)
+    int32_t max_ns;    // Most positive error (edge late)
+    int32_t p99_ns;    // 99th percentile of |error|
+    int32_t mean_ns;   // Mean error (a non-zero mean means a rate error)
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Clears the capture and starts (true) or stops (false) recording edges.
+ * Arming always starts from an empty buffer; disarming keeps the data for the report.
+ */
+void step_jitter_set_armed(bool armed);
+
+/**
+ * @brief True while edges are being recorded.
+ */
+bool step_jitter_is_armed();
+
+/**
+ * @brief Records one rising STEP edge. Called from the step interrupt (one producer).
+ * @param edge_us Time the edge was observed (microsecond timer, wraps).
+ * @param ideal_period_ns Intended time since the previous edge, or 0 if this edge
+ *        starts a new step sequence (only its time is kept, no period is recorded).
+ */
+void step_jitter_record_edge(uint32_t edge_us, uint32_t ideal_period_ns);
+
+/**
+ * @brief Computes the summary statistics. Sorts the capture, so only call it disarmed.
+ * @return Statistics; count is 0 if nothing was captured.
+ */
+StepJitterStats step_jitter_compute_stats();
+
+/**
+ * @brief Prints the statistics and a period-error histogram. Disarms capture first.
+ * @param source_label Describes where the edges were captured (e.g. "timer ISR").
+ */
+void step_jitter_report(const char* source_label);
+
+#endif // STEP_JITTER_H
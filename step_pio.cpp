@@ -0,0 +1,176 @@
+#include "step_pio.h"
+#include "step_timing.h"
+#include "step_pio.pio.h"      // Generated by pico_generate_pio_header
+
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include <cstdio>
+
+// --- Module-Internal Configuration ---
+const uint STEP_PIO_MAX_CHANNELS = 4; // Axes sharing the FIFO interrupt handler
+
+// --- Module-Internal State Variables ---
+static StepPioChannel* s_channels[STEP_PIO_MAX_CHANNELS] = {nullptr}; // Registered by step_pio_init
+static uint s_channelCount = 0;
+static bool s_irqInstalled[NUM_PIOS] = {false};                       // Per PIO block
+
+// --- Module-Internal Helper Functions ---
+
+static void step_pio_set_stream_irq(StepPioChannel* ch, bool enabled) {
+    pio_set_irqn_source_enabled(ch->pio, 0, pio_get_tx_fifo_not_full_interrupt_source(ch->sm), enabled);
+}
+
+static void step_pio_refill(StepPioChannel* ch) {
+    StepIntervalSource source = ch->stream_source;
+    if (!source) return; // Not streaming
+
+    while (!pio_sm_is_tx_fifo_full(ch->pio, ch->sm)) {
+        float interval_s = source(ch->stream_context);
+        if (interval_s == 0.0f) {
+            break; // End of stream: the PIO keeps repeating the last word
+        }
+        uint32_t word = 0; // Stop once the queued steps have played
+        if (interval_s > 0.0f) {
+            word = step_pio_encode_period((uint32_t)(interval_s * (float)ch->sm_clock_hz + 0.5f), ch->high_count);
+        }
+        pio_sm_put(ch->pio, ch->sm, word);
+        ch->last_word = word;
+        if (word == 0) break;
+    }
+    if (pio_sm_is_tx_fifo_full(ch->pio, ch->sm)) {
+        return; // More to come once the FIFO drains
+    }
+    ch->stream_source = nullptr;
+    step_pio_set_stream_irq(ch, false);
+}
+
+static void step_pio_irq_handler() {
+    // Shared by every channel; only streaming channels have work to do
+    for (uint i = 0; i < s_channelCount; ++i) {
+        step_pio_refill(s_channels[i]);
+    }
+}
+
+// --- Public Function Implementations ---
+
+bool step_pio_init(StepPioChannel* ch, uint step_pin, float pulse_high_us) {
+    ch->pio = nullptr;
+    ch->count_pio = nullptr;
+    ch->stream_source = nullptr;
+    if (s_channelCount >= STEP_PIO_MAX_CHANNELS) {
+        printf("Error: Too many step PIO channels.\n");
+        return false;
+    }
+    if (!pio_claim_free_sm_and_add_program_for_gpio_range(&step_pulse_program, &ch->pio, &ch->sm, &ch->offset, step_pin, 1, true)) {
+        printf("Error: No free PIO state machine for the step pulse program.\n");
+        ch->pio = nullptr;
+        return false;
+    }
+
+    ch->sm_clock_hz = clock_get_hz(clk_sys);
+    ch->high_count = step_pio_high_count((uint32_t)(pulse_high_us * (ch->sm_clock_hz / 1000000.0f) + 0.5f));
+
+    step_pulse_program_init(ch->pio, ch->sm, ch->offset, step_pin);
+
+    // Preload the fixed high count into ISR (the program never shifts into ISR)
+    pio_sm_put(ch->pio, ch->sm, ch->high_count);
+    pio_sm_exec(ch->pio, ch->sm, pio_encode_pull(false, true));
+    pio_sm_exec(ch->pio, ch->sm, pio_encode_mov(pio_isr, pio_osr));
+
+    ch->last_word = 0;
+    pio_sm_set_enabled(ch->pio, ch->sm, true); // Starts parked at 'idle'
+
+    // FIFO refill interrupt for streamed ramps (source enabled only while streaming)
+    s_channels[s_channelCount++] = ch;
+    uint pio_index = pio_get_index(ch->pio);
+    if (!s_irqInstalled[pio_index]) {
+        uint irq_num = pio_get_irq_num(ch->pio, 0);
+        irq_add_shared_handler(irq_num, step_pio_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(irq_num, true);
+        s_irqInstalled[pio_index] = true;
+    }
+
+    // Pulse counter on the same pin; stepping still works without it
+    if (pio_claim_free_sm_and_add_program_for_gpio_range(&step_count_program, &ch->count_pio, &ch->count_sm, &ch->count_offset, step_pin, 1, true)) {
+        step_count_program_init(ch->count_pio, ch->count_sm, ch->count_offset, step_pin);
+        pio_sm_set_enabled(ch->count_pio, ch->count_sm, true);
+    } else {
+        printf("Warning: No free PIO state machine for the step counter.\n");
+        ch->count_pio = nullptr;
+    }
+
+    printf("Step PIO: GPIO %u on pio%u sm%u, SM clock %lu Hz, high count %lu\n",
+           step_pin, pio_index, ch->sm, (unsigned long)ch->sm_clock_hz, (unsigned long)ch->high_count);
+    return true;
+}
+
+void step_pio_set_frequency(StepPioChannel* ch, float pps) {
+    if (!ch->pio) return;
+    if (ch->stream_source) {
+        ch->stream_source = nullptr;
+        step_pio_set_stream_irq(ch, false);
+    }
+
+    uint32_t word = step_pio_encode_pps(pps, ch->sm_clock_hz, ch->high_count);
+    if (word == 0) {
+        step_pio_stop(ch);
+        return;
+    }
+    if (word == ch->last_word) {
+        return; // The state machine already repeats this period on its own
+    }
+
+    // Only the newest period matters: drop any word still queued from an earlier update
+    // so a burst of updates never makes the state machine play stale periods in turn.
+    // The program picks the word up at the next period boundary, where the phase is zero,
+    // so the period in flight is never cut short or restarted. Each drained word costs
+    // the running period one extra cycle (the exec'd pull replaces one loop iteration).
+    if (!pio_sm_is_tx_fifo_empty(ch->pio, ch->sm)) {
+        pio_sm_drain_tx_fifo(ch->pio, ch->sm);
+    }
+    pio_sm_put(ch->pio, ch->sm, word);
+    ch->last_word = word;
+}
+
+void step_pio_stream_start(StepPioChannel* ch, StepIntervalSource source, void* context) {
+    if (!ch->pio || !source) return;
+    ch->stream_context = context;
+    ch->stream_source = source;
+    step_pio_set_stream_irq(ch, true); // Fires straight away while the FIFO has room
+}
+
+void step_pio_stop(StepPioChannel* ch) {
+    if (!ch->pio) return;
+    ch->stream_source = nullptr;
+    step_pio_set_stream_irq(ch, false);
+
+    // Abandon the period in flight and force the pin low via the idle instruction
+    pio_sm_set_enabled(ch->pio, ch->sm, false);
+    pio_sm_clear_fifos(ch->pio, ch->sm);
+    pio_sm_exec(ch->pio, ch->sm, pio_encode_jmp(ch->offset + step_pulse_offset_idle) | pio_encode_sideset_opt(1, 0));
+    pio_sm_set_enabled(ch->pio, ch->sm, true);
+    ch->last_word = 0;
+}
+
+bool step_pio_is_running(const StepPioChannel* ch) {
+    if (!ch->pio) return false;
+    // A stop word may still be queued behind steps that have not been played yet
+    return ch->last_word != 0 || !pio_sm_is_tx_fifo_empty(ch->pio, ch->sm) ||
+           pio_sm_get_pc(ch->pio, ch->sm) != ch->offset + step_pulse_offset_idle;
+}
+
+bool step_pio_is_queue_empty(const StepPioChannel* ch) {
+    return !ch->pio || pio_sm_is_tx_fifo_empty(ch->pio, ch->sm);
+}
+
+bool step_pio_has_step_count(const StepPioChannel* ch) {
+    return ch->count_pio != nullptr;
+}
+
+uint32_t step_pio_get_step_count(StepPioChannel* ch) {
+    if (!ch->count_pio) return 0;
+    // Sample X through the RX FIFO; the counter keeps running while we do
+    pio_sm_exec(ch->count_pio, ch->count_sm, pio_encode_mov(pio_isr, pio_x));
+    pio_sm_exec(ch->count_pio, ch->count_sm, pio_encode_push(false, false));
+    return 0u - pio_sm_get_blocking(ch->count_pio, ch->count_sm); // X counts down from 0
+}
@@ -0,0 +1,95 @@
+#ifndef STEP_PIO_H
+#define STEP_PIO_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+// --- Public Types ---
+
+/**
+ * @brief Supplies per-step intervals to a stream. Called from the PIO FIFO interrupt.
+ * @param context Pointer given to step_pio_stream_start().
+ * @return > 0: interval in seconds until the step after this one;
+ *         0: end of stream, keep repeating the last interval;
+ *         < 0: stop (pin parks low) once the queued steps have been played.
+ */
+typedef float (*StepIntervalSource)(void* context);
+
+/**
+ * @brief One step output: a pulse state machine plus an optional step counter.
+ * Each axis owns one; fields are managed by the step_pio_* functions.
+ */
+struct StepPioChannel {
+    PIO pio;                                  // nullptr until step_pio_init() succeeds
+    uint sm;
+    uint offset;
+    uint32_t sm_clock_hz;                     // State machine clock (clkdiv is 1)
+    uint32_t high_count;                      // Preloaded into ISR, see step_pio.pio
+    uint32_t last_word;                       // Last period word pushed (0 = parked)
+    volatile StepIntervalSource stream_source; // Non-null while streaming
+    void* stream_context;
+    PIO count_pio;                            // Step counter state machine (optional)
+    uint count_sm;
+    uint count_offset;
+};
+
+// --- Public Function Declarations ---
+
+/**
+ * @brief Claims a PIO state machine and loads the step pulse program onto the given pin.
+ * The pin is handed over to PIO and parked low. Call this once per channel, on the core
+ * that should service its FIFO interrupt.
+ * @param channel Channel to initialise (zeroed storage is fine).
+ * @param step_pin GPIO connected to the driver's STEP input.
+ * @param pulse_high_us Width of each STEP high pulse in microseconds.
+ * @return True on success, false if no free state machine or program space was available.
+ */
+bool step_pio_init(StepPioChannel* channel, uint step_pin, float pulse_high_us);
+
+/**
+ * @brief Sets the step frequency. The new period takes effect at the next period boundary.
+ * Only pushes a word to the TX FIFO when the encoded period actually changes, and
+ * replaces (rather than queues behind) any word that has not been picked up yet.
+ * @param pps Step frequency in pulses per second. Values <= 0 park the pin low.
+ */
+void step_pio_set_frequency(StepPioChannel* channel, float pps);
+
+/**
+ * @brief Streams per-step intervals (e.g. an acceleration ramp) into the TX FIFO.
+ * The source is polled from the FIFO-not-full interrupt only while the stream runs;
+ * once it returns 0 the interrupt is disabled and the PIO repeats the last period
+ * without any CPU involvement. Calling step_pio_set_frequency() ends the stream.
+ * @param source Interval callback, see StepIntervalSource.
+ * @param context Passed to every call of source.
+ */
+void step_pio_stream_start(StepPioChannel* channel, StepIntervalSource source, void* context);
+
+/**
+ * @brief Stops stepping immediately and leaves the STEP pin low.
+ */
+void step_pio_stop(StepPioChannel* channel);
+
+/**
+ * @brief Returns true until the state machine has played every queued step and parked.
+ */
+bool step_pio_is_running(const StepPioChannel* channel);
+
+/**
+ * @brief True once the state machine has taken every queued word. The last one may still be playing.
+ */
+bool step_pio_is_queue_empty(const StepPioChannel* channel);
+
+/**
+ * @brief True if step_pio_init() also got a state machine for the step counter.
+ */
+bool step_pio_has_step_count(const StepPioChannel* channel);
+
+/**
+ * @brief Returns the number of complete STEP pulses since init, counted by PIO.
+ * Wraps at 2^32; callers extend it by accumulating differences. Not reentrant:
+ * call it from one context only.
+ * @return Pulse count, or 0 if the counter is not available.
+ */
+uint32_t step_pio_get_step_count(StepPioChannel* channel);
+
+#endif // STEP_PIO_H
@@ -0,0 +1,159 @@
+#ifndef STEP_TIMING_H
+#define STEP_TIMING_H
+
+/**
+ * @file step_timing.h
+ * @brief Pure step-timing arithmetic shared by the step generation backends.
+ *
+ * Nothing in here touches the Pico SDK, so this header can also be compiled
+ * on the host to check the encoders against known values.
+ */
+
+#include <cstdint>
+
+// --- PIO Step Pulse Program Timing (see step_pio.pio) ---
+
+// Fixed cycles the step_pulse program spends around each loop.
+// High time = high_count + STEP_PIO_HIGH_OVERHEAD_CYCLES
+// Low time  = period word + STEP_PIO_LOW_OVERHEAD_CYCLES
+constexpr uint32_t STEP_PIO_HIGH_OVERHEAD_CYCLES = 2;
+constexpr uint32_t STEP_PIO_LOW_OVERHEAD_CYCLES = 5;
+
+// Shortest period the program can produce (a period word of 1 with no extra high time).
+constexpr uint32_t STEP_PIO_MIN_PERIOD_CYCLES = STEP_PIO_HIGH_OVERHEAD_CYCLES + STEP_PIO_LOW_OVERHEAD_CYCLES + 1;
+
+/**
+ * @brief Converts the wanted STEP high time into the loop count preloaded into the PIO ISR.
+ * @param pulse_cycles Desired high time in state machine cycles.
+ * @return High loop count (0 if the request is shorter than the program overhead).
+ */
+inline uint32_t step_pio_high_count(uint32_t pulse_cycles) {
+    if (pulse_cycles <= STEP_PIO_HIGH_OVERHEAD_CYCLES) {
+        return 0;
+    }
+    return pulse_cycles - STEP_PIO_HIGH_OVERHEAD_CYCLES;
+}
+
+/**
+ * @brief Encodes a full step period (in state machine cycles) into a TX FIFO period word.
+ * @param period_cycles The requested rising-edge to rising-edge period.
+ * @param high_count The high loop count the state machine was initialised with.
+ * @return The period word. Never 0, because 0 is the "park the pin low" command.
+ *         Periods shorter than the program can produce are clamped to its minimum.
+ */
+inline uint32_t step_pio_encode_period(uint32_t period_cycles, uint32_t high_count) {
+    uint64_t fixed_cycles = (uint64_t)high_count + STEP_PIO_HIGH_OVERHEAD_CYCLES + STEP_PIO_LOW_OVERHEAD_CYCLES;
+    if ((uint64_t)period_cycles <= fixed_cycles) {
+        return 1;
+    }
+    return (uint32_t)((uint64_t)period_cycles - fixed_cycles);
+}
+
+/**
+ * @brief Decodes a period word back into the period it produces (inverse of step_pio_encode_period).
+ */
+inline uint64_t step_pio_decode_period(uint32_t word, uint32_t high_count) {
+    return (uint64_t)word + high_count + STEP_PIO_HIGH_OVERHEAD_CYCLES + STEP_PIO_LOW_OVERHEAD_CYCLES;
+}
+
+/**
+ * @brief Converts a step rate into a period word for a state machine clocked at sm_clock_hz.
+ * @param pps Step frequency in pulses per second. Values <= 0 encode a stop.
+ * @param sm_clock_hz State machine clock (system clock / divider).
+ * @param high_count The high loop count the state machine was initialised with.
+ * @return The period word, or 0 (stop) if pps <= 0.
+ */
+inline uint32_t step_pio_encode_pps(float pps, uint32_t sm_clock_hz, uint32_t high_count) {
+    if (!(pps > 0.0f)) {
+        return 0;
+    }
+    float period = (float)sm_clock_hz / pps + 0.5f; // Round to the nearest cycle
+    if (period >= 4294967040.0f) {
+        return step_pio_encode_period(UINT32_MAX, high_count); // Slower than one step per ~28 s at 150 MHz
+    }
+    return step_pio_encode_period((uint32_t)period, high_count);
+}
+
+// --- Timer Backend Phase Accumulator ---
+
+// The timer backend can only fire on whole microseconds, but truncating the
+// half-period to whole microseconds (416.67 us -> 416 us at 1200 PPS) is a
+// steady speed error. Instead every edge time is accumulated with a 32-bit
+// fractional part (Q32.32 microseconds), and each alarm fires on the integer
+// part of its accumulated time. Individual edges jitter by < 1 us, but the
+// fraction is never dropped, so the average rate is exact to ~2^-32 us.
+
+constexpr uint64_t STEP_Q32_ONE_US = 1ull << 32;
+constexpr uint64_t STEP_MIN_HALF_PERIOD_Q32 = STEP_Q32_ONE_US; // 1 us: an alarm can't reschedule by 0
+
+/**
+ * @brief Absolute edge time: whole microseconds since boot plus a Q0.32 fraction.
+ */
+struct StepEdgeTime {
+    uint64_t us;
+    uint32_t frac;
+};
+
+/**
+ * @brief Converts a step rate into a half-period in Q32.32 microseconds.
+ * @param pps Step frequency in pulses per second.
+ * @return Half-period (timer toggles the pin twice per step), or 0 if pps <= 0.
+ */
+inline uint64_t step_half_period_q32(float pps) {
+    if (!(pps > 0.0f)) {
+        return 0;
+    }
+    double half_us = 500000.0 / (double)pps;
+    if (half_us >= 4294967295.0) {
+        return UINT64_MAX; // Slower than one toggle per ~71 minutes, saturate
+    }
+    uint64_t half_q32 = (uint64_t)(half_us * (double)STEP_Q32_ONE_US + 0.5);
+    return (half_q32 < STEP_MIN_HALF_PERIOD_Q32) ? STEP_MIN_HALF_PERIOD_Q32 : half_q32;
+}
+
+/**
+ * @brief Advances an edge time by a Q32.32 microsecond interval, carrying the fraction.
+ */
+inline StepEdgeTime step_edge_advance(StepEdgeTime t, uint64_t interval_q32) {
+    uint64_t frac_sum = (uint64_t)t.frac + (uint32_t)interval_q32;
+    t.frac = (uint32_t)frac_sum;
+    t.us += (interval_q32 >> 32) + (frac_sum >> 32);
+    return t;
+}
+
+/**
+ * @brief Computes when the next STEP toggle should land after a frequency change.
+ *
+ * The fraction of the current half-period that has already elapsed is carried
+ * over into the new half-period, so the edge in flight is neither cut short
+ * (runt pulse) nor restarted from "now" (stretched pulse / doubled edge).
+ *
+ * @param last_edge Scheduled time of the most recent toggle.
+ * @param old_half_q32 Half-period that was in effect since last_edge (Q32.32 us).
+ * @param new_half_q32 Half-period of the new frequency (Q32.32 us).
+ * @param now_us Current time.
+ * @return Time of the next toggle (never earlier than now_us, and never sooner after
+ *         last_edge than the shorter of the two half-periods).
+ */
+inline StepEdgeTime step_retime_next_edge(StepEdgeTime last_edge, uint64_t old_half_q32,
+                                          uint64_t new_half_q32, uint64_t now_us) {
+    const double q32 = (double)STEP_Q32_ONE_US;
+    StepEdgeTime now = {now_us, 0};
+    double elapsed_us = (double)(int64_t)(now_us - last_edge.us) - (double)last_edge.frac / q32;
+    if (old_half_q32 == 0) {
+        return step_edge_advance(now, new_half_q32); // No phase to carry
+    }
+    if (elapsed_us <= 0.0) {
+        // Same microsecond as the edge, before its fraction: a whole new half-period from it
+        return step_edge_advance(last_edge, new_half_q32);
+    }
+    double old_half_us = (double)old_half_q32 / q32;
+    if (elapsed_us >= old_half_us) {
+        return now; // Edge is already due
+    }
+    // remaining = (1 - elapsed/old) * new
+    double remaining_us = (1.0 - elapsed_us / old_half_us) * ((double)new_half_q32 / q32);
+    return step_edge_advance(now, (uint64_t)(remaining_us * q32));
+}
+
+#endif // STEP_TIMING_H